@@ -138,7 +138,9 @@ void loop()
       {
         String received = myLora.getRx();
         received = myLora.base16decode(received);
-        Serial.print("Received downlink: " + received);
+        Serial.print("Received downlink on port ");
+        Serial.print(myLora.getRxPort());
+        Serial.print(": " + received);
         break;
       }
       default:
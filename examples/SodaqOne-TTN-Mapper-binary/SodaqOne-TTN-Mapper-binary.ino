@@ -57,16 +57,21 @@ function Decoder(bytes, port) {
  */
 #include "Sodaq_UBlox_GPS.h"
 #include <rn2xx3.h>
+#include <rn2xx3_hex.h>
+#include <rn2xx3_payload.h>
 
 // Create an instance of the rn2xx3 library,
 // Giving Serial1 as stream to use for communication with the radio
 rn2xx3 myLora(Serial1);
 
-String toLog;
+// The payload layout, matching the decoder function above
+static const rn2xx3_field MAPPER[] PROGMEM = {
+    {24, false, 16777215 / 180.0, -90},  // latitude
+    {24, false, 16777215 / 360.0, -180}, // longitude
+    {16, true, 1, 0},                    // altitude in m
+    {8, false, 10, 0}};                  // HDOP
+
 uint8_t txBuffer[9];
-uint32_t LatitudeBinary, LongitudeBinary;
-uint16_t altitudeGps;
-uint8_t hdopGps;
 int dr = 0;
 
 void setup()
@@ -168,31 +173,14 @@ void loop()
 
   digitalWrite(LED_RED, HIGH);
 
-  LatitudeBinary = ((sodaq_gps.getLat() + 90) / 180) * 16777215;
-  LongitudeBinary = ((sodaq_gps.getLon() + 180) / 360) * 16777215;
-
-  txBuffer[0] = ( LatitudeBinary >> 16 ) & 0xFF;
-  txBuffer[1] = ( LatitudeBinary >> 8 ) & 0xFF;
-  txBuffer[2] = LatitudeBinary & 0xFF;
-
-  txBuffer[3] = ( LongitudeBinary >> 16 ) & 0xFF;
-  txBuffer[4] = ( LongitudeBinary >> 8 ) & 0xFF;
-  txBuffer[5] = LongitudeBinary & 0xFF;
-
-  altitudeGps = sodaq_gps.getAlt();
-  txBuffer[6] = ( altitudeGps >> 8 ) & 0xFF;
-  txBuffer[7] = altitudeGps & 0xFF;
-
-  hdopGps = sodaq_gps.getHDOP()*10;
-  txBuffer[8] = hdopGps & 0xFF;
-
-  toLog = "";
-  for(size_t i = 0; i<sizeof(txBuffer); i++)
-  {
-    char buffer[3];
-    sprintf(buffer, "%02x", txBuffer[i]);
-    toLog = toLog + String(buffer);
-  }
+  // The packer rounds to the nearest step, so latitude, longitude and
+  // altitude can be one step above what a cast used to truncate them to.
+  // HDOP is still cut to tenths.
+  rn2xx3_packer packer(MAPPER, 4, txBuffer, sizeof(txBuffer));
+  packer.add(sodaq_gps.getLat())
+      .add(sodaq_gps.getLon())
+      .add(sodaq_gps.getAlt())
+      .add(floor(sodaq_gps.getHDOP() * 10) / 10);
 
   SerialUSB.print("Transmit on DR");
   SerialUSB.print(dr);
@@ -205,11 +193,12 @@ void loop()
   SerialUSB.print(" and HDOP ");
   SerialUSB.print(sodaq_gps.getHDOP(), 2);
   SerialUSB.print(" hex ");
-  SerialUSB.println(toLog);
+  rn2xx3_hex::print(SerialUSB, txBuffer, packer.length(), true);
+  SerialUSB.println();
 
   // Turn on blue to indicate Lora usage
   digitalWrite(LED_BLUE, LOW);
-  myLora.txBytes(txBuffer, sizeof(txBuffer));
+  myLora.txBytes(txBuffer, packer.length());
   digitalWrite(LED_BLUE, HIGH);
 
   // Cycle between datarate 0 and 5
@@ -70,17 +70,22 @@ function Decoder(bytes, port) {
 #include "TinyGPS++.h"
 #include <SoftwareSerial.h>
 #include <rn2xx3.h>
+#include <rn2xx3_hex.h>
+#include <rn2xx3_payload.h>
 
 SoftwareSerial gpsSerial(8, 9); // RX, TX
 TinyGPSPlus gps;
 rn2xx3 myLora(Serial1);
 
 unsigned long last_update = 0;
-String toLog;
 uint8_t txBuffer[9];
-uint32_t LatitudeBinary, LongitudeBinary;
-uint16_t altitudeGps;
-uint8_t hdopGps;
+
+// The payload layout, matching the decoder function above
+static const rn2xx3_field MAPPER[] PROGMEM = {
+    {24, false, 16777215 / 180.0, -90},  // latitude
+    {24, false, 16777215 / 360.0, -180}, // longitude
+    {16, true, 1, 0},                    // altitude in m
+    {8, false, 10, 0}};                  // HDOP
 
 #define PMTK_SET_NMEA_UPDATE_05HZ  "$PMTK220,2000*1C"
 #define PMTK_SET_NMEA_UPDATE_1HZ  "$PMTK220,1000*1F"
@@ -162,10 +167,11 @@ void loop() {
     Serial.print("Interval: ");
     Serial.println(millis()-last_update);
 
-    build_packet();
+    uint8_t txLength = build_packet();
 
-    Serial.println(toLog);
-    myLora.txBytes(txBuffer, sizeof(txBuffer));
+    rn2xx3_hex::print(Serial, txBuffer, txLength, true);
+    Serial.println();
+    myLora.txBytes(txBuffer, txLength);
     Serial.println("TX done");
 
     led_off();
@@ -175,33 +181,17 @@ void loop() {
 
 }
 
-void build_packet()
+uint8_t build_packet()
 {
-  LatitudeBinary = ((gps.location.lat() + 90) / 180.0) * 16777215;
-  LongitudeBinary = ((gps.location.lng() + 180) / 360.0) * 16777215;
-
-  txBuffer[0] = ( LatitudeBinary >> 16 ) & 0xFF;
-  txBuffer[1] = ( LatitudeBinary >> 8 ) & 0xFF;
-  txBuffer[2] = LatitudeBinary & 0xFF;
-
-  txBuffer[3] = ( LongitudeBinary >> 16 ) & 0xFF;
-  txBuffer[4] = ( LongitudeBinary >> 8 ) & 0xFF;
-  txBuffer[5] = LongitudeBinary & 0xFF;
-
-  altitudeGps = gps.altitude.meters();
-  txBuffer[6] = ( altitudeGps >> 8 ) & 0xFF;
-  txBuffer[7] = altitudeGps & 0xFF;
-
-  hdopGps = gps.hdop.value()/10;
-  txBuffer[8] = hdopGps & 0xFF;
-
-  toLog = "";
-  for(size_t i = 0; i<sizeof(txBuffer); i++)
-  {
-    char buffer[3];
-    sprintf(buffer, "%02x", txBuffer[i]);
-    toLog = toLog + String(buffer);
-  }
+  // The packer rounds to the nearest step, so latitude, longitude and
+  // altitude can be one step above what a cast used to truncate them to.
+  // HDOP is still cut to tenths.
+  rn2xx3_packer packer(MAPPER, 4, txBuffer, sizeof(txBuffer));
+  packer.add(gps.location.lat())
+      .add(gps.location.lng())
+      .add(gps.altitude.meters())
+      .add((gps.hdop.value() / 10) / 10.0);
+  return packer.length();
 }
 
 void led_on(){
@@ -0,0 +1,32 @@
+#!/bin/sh
+#
+# Report the flash and RAM use of the examples per board, as built by
+# PlatformIO. Run from the root of the repository, with platformio installed:
+#
+#   extras/footprint.sh
+#
+# Compare the output before and after a change to see its footprint.
+
+set -e
+
+report()
+{
+  example=$1
+  board=$2
+  shift 2
+  for lib in "$@"; do
+    platformio lib install "$lib" > /dev/null
+  done
+  printf '%-45s %-15s' "$example" "$board"
+  platformio ci --lib="./src" --board="$board" "examples/$example" 2>&1 |
+    sed -n 's/^\(RAM\|Flash\):.*(used \([0-9]*\) bytes.*/ \1 \2/p' | tr -d '\n'
+  echo
+}
+
+report ArduinoUnoNano-basic uno
+report ArduinoUnoNano-downlink uno
+report TheThingsUno-basic leonardo
+report TheThingsUno-GPSshield-TTN-Mapper-binary leonardo
+report ESP8266-RN2483-basic d1_mini
+report SodaqAutonomo-basic sodaq_autonomo
+report SodaqOne-TTN-Mapper-binary sodaq_one Sodaq_UBlox_GPS
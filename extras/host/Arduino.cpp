@@ -0,0 +1,149 @@
+/*
+ * Minimal Arduino API for building the rn2xx3 library on a Linux host.
+ *
+ */
+
+#include "Arduino.h"
+
+#include <vector>
+#include <algorithm>
+
+HostSerial Serial;
+
+static uint64_t hostNow = 0;
+
+static std::vector<HostEventSource *> &eventSources()
+{
+  static std::vector<HostEventSource *> sources;
+  return sources;
+}
+
+HostEventSource::HostEventSource()
+{
+  eventSources().push_back(this);
+}
+
+HostEventSource::~HostEventSource()
+{
+  std::vector<HostEventSource *> &sources = eventSources();
+  sources.erase(std::remove(sources.begin(), sources.end(), this), sources.end());
+}
+
+uint64_t hostMicros()
+{
+  return hostNow;
+}
+
+void hostAdvance(uint64_t us)
+{
+  hostNow += us;
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(hostNow / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)hostNow;
+}
+
+void delay(unsigned long ms)
+{
+  hostNow += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  hostNow += us;
+}
+
+void yield()
+{
+  // Waiting code calls yield() in a loop: skip straight to the next event.
+  // Without any pending event, time still has to move for timeouts.
+  uint64_t next = UINT64_MAX;
+  std::vector<HostEventSource *> &sources = eventSources();
+  for (size_t i = 0; i < sources.size(); i++)
+  {
+    next = std::min(next, sources[i]->nextEventMicros());
+  }
+
+  if (next > hostNow && next != UINT64_MAX)
+    hostNow = next;
+  else if (next == UINT64_MAX)
+    hostNow += 1000;
+}
+
+std::string String::number(unsigned long value, unsigned char base, bool negative)
+{
+  char buffer[34];
+  char *p = &buffer[sizeof(buffer) - 1];
+  *p = '\0';
+  if (base < 2)
+    base = 10;
+  do
+  {
+    unsigned digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  if (negative)
+    *--p = '-';
+  return std::string(p);
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+int Print::printf(const char *format, ...)
+{
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (len > (int)sizeof(buffer) - 1)
+    len = sizeof(buffer) - 1;
+  if (len > 0)
+    write((const uint8_t *)buffer, len);
+  return len;
+}
+
+String Stream::readStringUntil(char terminator)
+{
+  std::string ret;
+  unsigned long start = millis();
+  while (millis() - start < _timeout)
+  {
+    if (available())
+    {
+      int c = read();
+      if (c == terminator)
+        break;
+      ret += (char)c;
+      start = millis();
+    }
+    else
+    {
+      yield();
+    }
+  }
+  return String(ret);
+}
+
+size_t HostSerial::write(uint8_t c)
+{
+  static bool enabled = getenv("RN2XX3_HOST_SERIAL") != NULL;
+  if (enabled)
+    fputc(c, stderr);
+  return 1;
+}
@@ -0,0 +1,238 @@
+/*
+ * Minimal Arduino API for building the rn2xx3 library on a Linux host.
+ *
+ * Only what the library and the host benchmarks use is provided.
+ * Time is virtual: millis(), micros() and delay() run on a clock that
+ * jumps to the next event of the simulated modules whenever the code
+ * waits, so simulated hours of traffic take milliseconds.
+ *
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+typedef uint8_t byte;
+
+// Flash strings are plain strings on the host
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+#define PROGMEM
+#define PSTR(s) (s)
+typedef const char *PGM_P;
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void *const *)(addr))
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+/*
+ * Something that produces events on the virtual clock, like a simulated
+ * RN2xx3. When the code waits, the clock jumps to the earliest event.
+ */
+class HostEventSource
+{
+public:
+  HostEventSource();
+  virtual ~HostEventSource();
+
+  // Virtual time in microseconds of the next event, or UINT64_MAX
+  virtual uint64_t nextEventMicros() = 0;
+};
+
+// Current virtual time in microseconds
+uint64_t hostMicros();
+
+// Advance the virtual clock by the given number of microseconds
+void hostAdvance(uint64_t us);
+
+class String
+{
+public:
+  String(const char *cstr = "") : _s(cstr ? cstr : "") {}
+  String(const __FlashStringHelper *str) : _s(reinterpret_cast<const char *>(str)) {}
+  String(const std::string &str) : _s(str) {}
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int value, unsigned char base = 10) : _s(number(value, base)) {}
+  explicit String(unsigned int value, unsigned char base = 10) : _s(number(value, base)) {}
+  explicit String(long value, unsigned char base = 10) : _s(number(value, base)) {}
+  explicit String(unsigned long value, unsigned char base = 10) : _s(number(value, base)) {}
+
+  unsigned int length() const { return _s.size(); }
+  const char *c_str() const { return _s.c_str(); }
+  unsigned char reserve(unsigned int size)
+  {
+    _s.reserve(size);
+    return 1;
+  }
+
+  char charAt(unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+
+  String &operator+=(const String &rhs)
+  {
+    _s += rhs._s;
+    return *this;
+  }
+  String &operator+=(const char *rhs)
+  {
+    _s += rhs;
+    return *this;
+  }
+  String &operator+=(const __FlashStringHelper *rhs)
+  {
+    _s += reinterpret_cast<const char *>(rhs);
+    return *this;
+  }
+  String &operator+=(char rhs)
+  {
+    _s += rhs;
+    return *this;
+  }
+  String &operator+=(int rhs) { return *this += String(rhs); }
+  String &operator+=(unsigned int rhs) { return *this += String(rhs); }
+  String &operator+=(long rhs) { return *this += String(rhs); }
+  String &operator+=(unsigned long rhs) { return *this += String(rhs); }
+  unsigned char concat(const char *cstr, unsigned int length)
+  {
+    _s.append(cstr, length);
+    return 1;
+  }
+
+  bool operator==(const String &rhs) const { return _s == rhs._s; }
+  bool operator==(const char *rhs) const { return _s == rhs; }
+  bool operator!=(const String &rhs) const { return _s != rhs._s; }
+  bool operator!=(const char *rhs) const { return _s != rhs; }
+  unsigned char equals(const String &rhs) const { return _s == rhs._s; }
+  unsigned char equalsIgnoreCase(const String &rhs) const { return strcasecmp(c_str(), rhs.c_str()) == 0; }
+  unsigned char startsWith(const String &prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+  unsigned char endsWith(const String &suffix) const
+  {
+    return _s.size() >= suffix._s.size() && _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+  }
+
+  int indexOf(char c, unsigned int from = 0) const
+  {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  String substring(unsigned int from) const { return from > _s.size() ? String() : String(_s.substr(from)); }
+  String substring(unsigned int from, unsigned int to) const
+  {
+    if (from > _s.size())
+      return String();
+    return String(_s.substr(from, to > from ? to - from : 0));
+  }
+
+  long toInt() const { return atol(c_str()); }
+  void trim()
+  {
+    size_t first = _s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+    {
+      _s.clear();
+      return;
+    }
+    _s = _s.substr(first, _s.find_last_not_of(" \t\r\n") - first + 1);
+  }
+
+private:
+  static std::string number(unsigned long value, unsigned char base, bool negative = false);
+  static std::string number(long value, unsigned char base)
+  {
+    return value < 0 ? number((unsigned long)-value, base, true) : number((unsigned long)value, base);
+  }
+  static std::string number(int value, unsigned char base) { return number((long)value, base); }
+  static std::string number(unsigned int value, unsigned char base) { return number((unsigned long)value, base); }
+
+  std::string _s;
+};
+
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+  size_t print(const __FlashStringHelper *str) { return write(reinterpret_cast<const char *>(str)); }
+  size_t print(const String &str) { return write(str.c_str(), str.length()); }
+  size_t print(const char *str) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC) { return print(String(value, base)); }
+  size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T value)
+  {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(T value, int base)
+  {
+    size_t n = print(value, base);
+    return n + println();
+  }
+
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+  String readStringUntil(char terminator);
+
+protected:
+  unsigned long _timeout = 1000;
+};
+
+/*
+ * The debug serial port. Output is discarded, unless the environment
+ * variable RN2XX3_HOST_SERIAL is set, in which case it goes to stderr.
+ */
+class HostSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c);
+  using Print::write;
+  int available() { return 0; }
+  int read() { return -1; }
+  int peek() { return -1; }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,534 @@
+/*
+ * Throughput benchmark of the rn2xx3 library against simulated modules.
+ *
+ * All times except the last column are virtual: they are what the
+ * exchange would take on a real RN2xx3 at 57600 baud.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+#include "rn2xx3_sim.h"
+
+#include <chrono>
+
+static const char *APP_EUI = "70B3D57ED00001A6";
+static const char *APP_KEY = "A23C96EE13804963F8C2BD6285448198";
+static const char *DEV_ADDR = "0203FFEE";
+static const char *APP_SKEY = "8D7FFEF938589D95AAD928C2E2E7E48F";
+static const char *NWK_SKEY = "AE17E567AECC8787F749A62F5541D522";
+
+struct measurement
+{
+  uint64_t startUs;
+  std::chrono::steady_clock::time_point startWall;
+  rn2xx3_sim *sim;
+
+  measurement(rn2xx3_sim &s) : startUs(hostMicros()), startWall(std::chrono::steady_clock::now()), sim(&s)
+  {
+    sim->resetCounters();
+  }
+
+  void report(const char *name, bool ok)
+  {
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startWall).count();
+    printf("%-40s %10.1f %9lu %9lu %9lu %10.3f %s\n", name, (hostMicros() - startUs) / 1000.0, sim->commands(),
+           sim->bytesFromHost(), sim->bytesToHost(), wallMs, ok ? "" : "FAILED");
+  }
+};
+
+static void bootToFirstUplink(const char *name, RN2xx3_t model, bool otaa, int plan)
+{
+  rn2xx3_sim sim(model);
+  rn2xx3 lora(sim);
+  measurement m(sim);
+
+  bool ok = otaa ? lora.initOTAA(APP_EUI, APP_KEY) : lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  if (plan >= 0)
+    ok = lora.setFrequencyPlan((FREQ_PLAN)plan) && ok;
+  ok = lora.tx("hello") == TX_SUCCESS && ok;
+  m.report(name, ok);
+}
+
+static void bootP2P()
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  measurement m(sim);
+
+  bool ok = lora.initP2P();
+  ok = lora.tx("hello") == TX_SUCCESS && ok;
+  m.report("boot P2P -> first tx", ok);
+}
+
+static void p2pProfileSwitch(bool reinit)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initP2P();
+
+  rn2xx3_radio_profile fast;
+  rn2xx3_radio_profile longRange;
+  longRange.sf = 12;
+  longRange.cr = 4;
+
+  // Alternate between the profiles, with one frame in each
+  measurement m(sim);
+  bool ok = true;
+  for (int i = 0; i < 10; i++)
+  {
+    const rn2xx3_radio_profile &profile = i % 2 ? fast : longRange;
+    ok = (reinit ? lora.initP2P(profile) : lora.setRadioProfile(profile)) && ok;
+    ok = lora.tx("hello") == TX_SUCCESS && ok;
+  }
+  m.report(reinit ? "10 P2P profile switches, initP2P()" : "10 P2P profile switches, setRadioProfile()", ok);
+}
+
+static unsigned long p2pFrames;
+
+static void countFrame(const uint8_t *, uint16_t length)
+{
+  if (length == 4)
+    p2pFrames++;
+}
+
+static void p2pCollector(bool background)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initP2P();
+  p2pFrames = 0;
+
+  // 40 frames, a quiet minute that outlasts the watchdog, then 5 more
+  measurement m(sim);
+  unsigned long start = millis();
+  for (int i = 0; i < 45; i++)
+    sim.receiveP2P("01020304", 7, start + 700 + i * 2300UL + (i >= 40 ? 60000 : 0));
+
+  // Meanwhile a console command is due every 10 s
+  if (background)
+    lora.startListenP2P(countFrame);
+  unsigned long nextCommand = start + 10000;
+  unsigned long worstDelay = 0;
+  bool ok = true;
+  while (millis() - start < 180000UL)
+  {
+    if ((long)(millis() - nextCommand) >= 0)
+    {
+      if (millis() - nextCommand > worstDelay)
+        worstDelay = millis() - nextCommand;
+      ok = lora.getVbat() > 0 && ok;
+      nextCommand += 10000;
+    }
+    if (background)
+      lora.poll();
+    else if (lora.listenP2P() == TX_WITH_RX)
+      p2pFrames++;
+    delay(10);
+  }
+  m.report(background ? "P2P listen in the background" : "P2P listenP2P() loop", ok && lora.getRx() == "01020304");
+  printf("    %lu of 45 frames, console commands up to %lu ms late\n", p2pFrames, worstDelay);
+}
+
+static void p2pRing(unsigned long drainEveryMs)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initP2P();
+
+  // A burst of 40 frames of 8 bytes, 250 ms apart, each with its own SNR
+  measurement m(sim);
+  unsigned long start = millis();
+  for (int i = 0; i < 40; i++)
+  {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%02X00000000000000", i);
+    sim.receiveP2P(hex, i % 20 - 10, start + 1000 + i * 250UL);
+  }
+
+  lora.startListenP2P();
+  unsigned long nextDrain = start + drainEveryMs;
+  unsigned long received = 0;
+  unsigned long lastAt = 0;
+  bool ok = true;
+  while (millis() - start < 20000UL)
+  {
+    lora.poll();
+    if ((long)(millis() - nextDrain) >= 0)
+    {
+      uint8_t buffer[64];
+      rn2xx3_frame_info info[8];
+      uint8_t count;
+      while ((count = lora.readFramesP2P(buffer, sizeof(buffer), info, 8)) > 0)
+      {
+        for (uint8_t i = 0; i < count; i++)
+        {
+          int index = buffer[i * 8];
+          ok = ok && info[i].length == 8 && info[i].snr == index % 20 - 10 && info[i].at > lastAt;
+          lastAt = info[i].at;
+        }
+        received += count;
+      }
+      nextDrain += drainEveryMs;
+    }
+    delay(10);
+  }
+  ok = ok && received + lora.getDroppedFramesP2P() == 40;
+  char name[48];
+  snprintf(name, sizeof(name), "P2P burst, ring read every %lu ms", drainEveryMs);
+  m.report(name, ok);
+  printf("    %lu of 40 frames read, %lu dropped\n", received, lora.getDroppedFramesP2P());
+}
+
+static void warmBoot(const char *name, bool otaa, bool moduleRestart)
+{
+  rn2xx3_sim sim(RN2483);
+  {
+    rn2xx3 before(sim);
+    if (otaa)
+      before.initOTAA(APP_EUI, APP_KEY);
+    else
+      before.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+    before.tx("hello");
+  }
+  if (moduleRestart)
+  {
+    sim.powerCycle();
+    delay(200);
+  }
+
+  // A new instance, as after a reset of the MCU
+  rn2xx3 lora(sim);
+  measurement m(sim);
+  bool ok = otaa ? lora.initOTAA(APP_EUI, APP_KEY) : lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  ok = lora.tx("hello") == TX_SUCCESS && ok;
+  m.report(name, ok);
+}
+
+static void commandRate()
+{
+  rn2xx3_sim sim(RN2903);
+  rn2xx3 lora(sim);
+  lora.initOTAA(APP_EUI, APP_KEY);
+
+  lora.invalidateCache();
+  measurement m(sim);
+  bool ok = lora.setFrequencyPlan(TTN_US);
+  m.report("setFrequencyPlan(TTN_US)", ok);
+  printf("    %.0f commands/s, last round trip %lu us\n",
+         sim.commands() / ((hostMicros() - m.startUs) / 1e6), lora.getLastCommandRoundTrip());
+}
+
+static void autobaudSync()
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  measurement m(sim);
+  bool ok = lora.autobaud();
+  m.report("autobaud()", ok);
+}
+
+// The board's serial port, switched by setBaudRate()
+static rn2xx3_sim *boardPort;
+
+static void switchBaud(unsigned long baud)
+{
+  boardPort->setBaud(baud);
+}
+
+static void fastLink(unsigned long baud)
+{
+  rn2xx3_sim sim(RN2903);
+  rn2xx3 lora(sim);
+  boardPort = &sim;
+  bool ok = lora.initOTAA(APP_EUI, APP_KEY);
+  lora.setDR(3);
+  lora.invalidateCache();
+
+  // A full frequency plan and writing a large uplink, without its RX windows
+  measurement m(sim);
+  if (baud != RN2XX3_DEFAULT_BAUD)
+    ok = lora.setBaudRate(baud, switchBaud) && ok;
+  ok = lora.setFrequencyPlan(TTN_US) && ok;
+  byte payload[200] = {0};
+  ok = lora.beginTxBytes(payload, sizeof(payload)) && ok;
+
+  char name[48];
+  snprintf(name, sizeof(name), "TTN_US plan + 200 byte tx, %lu baud", baud);
+  m.report(name, ok);
+  while (lora.poll())
+    yield();
+  if (lora.txResult() == TX_FAIL)
+    printf("    uplink FAILED\n");
+}
+
+static void sleepCycle(bool early)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+
+  // A battery node: sleep, wake, send. Waking early cuts the sleep short
+  // by a break, otherwise the module wakes itself just before the uplink.
+  measurement m(sim);
+  unsigned long worst = 0;
+  bool ok = true;
+  for (int i = 0; i < 10; i++)
+  {
+    lora.sleep(early ? 600000 : 290000);
+    delay(300000);
+    ok = lora.wake() && ok;
+    if (lora.getLastWakeLatency() > worst)
+      worst = lora.getLastWakeLatency();
+    ok = lora.tx("hello") == TX_SUCCESS && ok;
+  }
+  m.report(early ? "10 sleep cycles, woken by a break" : "10 sleep cycles, woken by the timer", ok);
+  printf("    wake to ready at most %lu us\n", worst);
+}
+
+static void uplinkBytes()
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+
+  const byte payload[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  measurement m(sim);
+  bool ok = lora.txBytes(payload, sizeof(payload)) == TX_SUCCESS;
+  m.report("uplink of 10 bytes", ok);
+}
+
+static void dutyCycleBound()
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  lora.setFrequencyPlan(DEFAULT_EU);
+  lora.setDR(0);
+
+  // Three channels, so the fourth uplink has to wait for the duty cycle
+  measurement m(sim);
+  bool ok = true;
+  for (int i = 0; i < 6; i++)
+    ok = lora.tx("hello") == TX_SUCCESS && ok;
+  m.report("6 uplinks at DR0, duty cycle bound", ok);
+  printf("    %lu uplinks, %lu us time on air each, next uplink allowed in %lu s\n", sim.uplinks(),
+         (unsigned long)lora.getTimeOnAir(5), (lora.nextTxAllowedAt() - millis()) / 1000);
+}
+
+static void dataRateControl(bool controlled)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  lora.setFrequencyPlan(TTN_EU);
+  lora.setDR(0);
+  if (controlled)
+    lora.enableDataRateControl(5, 60);
+
+  // 20 bytes every 2 minutes: 30 on a strong link, then 30 on a weak one
+  measurement m(sim);
+  uint64_t strongAirtimeUs = 0;
+  byte data[20] = {0};
+  bool ok = true;
+  for (int i = 0; i < 60; i++)
+  {
+    if (i == 30)
+      strongAirtimeUs = sim.airtimeUs();
+    sim.setUplinkSnr(i < 30 ? 5 : -11);
+    ok = lora.txBytes(data, sizeof(data)) != TX_FAIL && ok;
+    delay(120000);
+  }
+  m.report(controlled ? "60 uplinks, data rate control" : "60 uplinks at DR0", ok);
+  printf("    %.1f s on air on the strong link, %.1f s on the weak one, ending at DR%s\n", strongAirtimeUs / 1e6,
+         (sim.airtimeUs() - strongAirtimeUs) / 1e6, lora.sendRawCommand("mac get dr").c_str());
+}
+
+static void queuedTelemetry(bool queued)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  lora.setFrequencyPlan(TTN_EU);
+
+  // A 4 byte reading every 30 s for 30 minutes, every 20th is an alarm
+  measurement m(sim);
+  unsigned long start = millis();
+  unsigned long next = start;
+  bool ok = true;
+  bool pending = false;
+  for (int reading = 0; reading < 60;)
+  {
+    if ((long)(millis() - next) >= 0)
+    {
+      next += 30000;
+      byte data[4] = {(byte)reading, 0x12, 0x34, 0x56};
+      bool alarm = reading % 20 == 19;
+      if (queued)
+        ok = lora.queueUplink(data, sizeof(data), alarm ? UPLINK_URGENT : UPLINK_NORMAL, 300000) && ok;
+      else
+        ok = lora.txBytes(data, sizeof(data)) != TX_FAIL && ok;
+      reading++;
+    }
+    if (queued)
+    {
+      // A frame ended when poll() stops reporting it
+      bool wasPending = pending;
+      pending = lora.poll();
+      if (wasPending && !pending)
+        ok = lora.txResult() != TX_FAIL && ok;
+    }
+    delay(10);
+  }
+  while (queued && lora.getQueuedUplinks() > 0)
+  {
+    // The duty cycle may hold the frame back, which is no failure
+    bool ran = lora.txPending() || lora.sendQueuedUplinks();
+    while (lora.poll())
+    {
+      ran = true;
+      delay(10);
+    }
+    if (ran)
+      ok = lora.txResult() != TX_FAIL && ok;
+  }
+  m.report(queued ? "60 readings, queued" : "60 readings, one uplink each", ok && lora.getDroppedUplinks() == 0);
+
+  printf("    %lu uplinks, %lu ms time on air\n", sim.uplinks(), (unsigned long)(sim.airtimeUs() / 1000));
+}
+
+static unsigned long downlinksOnPort1;
+static unsigned long downlinksOther;
+
+static void countPort1(uint8_t port, const uint8_t *payload, uint16_t length)
+{
+  if (port == 1 && length == 2 && payload[0] == 0xCA)
+    downlinksOnPort1++;
+}
+
+static void countOther(uint8_t port, const uint8_t *, uint16_t)
+{
+  if (port != 1)
+    downlinksOther++;
+}
+
+static void downlinkBurst(bool automaticReply)
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.setAutomaticReply(automaticReply);
+  lora.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  lora.setFrequencyPlan(TTN_EU);
+  lora.onDownlink(1, countPort1);
+  lora.onDownlink(0, countOther);
+  downlinksOnPort1 = downlinksOther = 0;
+
+  // Four downlinks wait at the network when the device sends its reading
+  sim.queueDownlink(1, "CAFE");
+  sim.queueDownlink(2, "01");
+  sim.queueDownlink(1, "CA01");
+  sim.queueDownlink(3, "0203");
+
+  measurement m(sim);
+  unsigned long start = millis();
+  bool ok = true;
+  while (downlinksOnPort1 + downlinksOther < 4 && millis() - start < 600000UL)
+  {
+    // One reading per minute, and between readings only poll()
+    if (sim.uplinks() == 0 || (!automaticReply && millis() - start >= 60000UL * sim.uplinks()))
+      ok = lora.tx("hello") != TX_FAIL && ok;
+    lora.poll();
+    delay(10);
+  }
+  ok = ok && downlinksOnPort1 == 2 && downlinksOther == 2 && lora.getRxPort() == 3;
+  m.report(automaticReply ? "4 downlinks, automatic reply" : "4 downlinks, one per uplink", ok);
+  printf("    %lu uplinks including automatic replies, last downlink after %lu ms\n", sim.uplinks(), millis() - start);
+}
+
+static void printHistogram(const char *name, const uint16_t *histogram)
+{
+  printf("    %-18s", name);
+  for (uint8_t i = 0; i < RN2XX3_LATENCY_BUCKETS; i++)
+  {
+    if (histogram[i] && i == RN2XX3_LATENCY_BUCKETS - 1)
+      printf(" >=%lums:%u", 1UL << (i - 1), histogram[i]);
+    else if (histogram[i])
+      printf(" <%lums:%u", 1UL << i, histogram[i]);
+  }
+  printf("\n");
+}
+
+static void simulatedHour()
+{
+  rn2xx3_sim sim(RN2483);
+  rn2xx3 lora(sim);
+  lora.initOTAA(APP_EUI, APP_KEY);
+  lora.setFrequencyPlan(TTN_EU);
+
+  measurement m(sim);
+  lora.resetStats();
+  unsigned long start = millis();
+  unsigned long next = start;
+  bool ok = true;
+  while (millis() - start < 3600000UL)
+  {
+    if ((long)(millis() - next) >= 0)
+    {
+      next += 60000;
+      if (sim.uplinks() % 10 == 5)
+        sim.queueDownlink(1, "01020304");
+      ok = lora.tx("hello") != TX_FAIL && ok;
+    }
+    delay(10);
+  }
+  // The library's own counters agree with what the module saw
+  rn2xx3_stats stats;
+  lora.getStats(stats, true);
+  ok = stats.commands == sim.commands() && stats.bytesWritten == sim.bytesFromHost() &&
+       stats.bytesRead == sim.bytesToHost() && ok;
+  m.report("simulated hour, 1 uplink per minute", ok);
+  printf("    %lu uplinks, %lu retries, %lu busy, %lu no_free_ch\n", sim.uplinks(), stats.retries, stats.busy,
+         stats.noFreeChannel);
+  printHistogram("command -> reply", stats.commandLatency);
+  printHistogram("ok -> mac_tx_ok", stats.txLatency);
+}
+
+int main()
+{
+  printf("%-40s %10s %9s %9s %9s %10s\n", "scenario", "virt ms", "commands", "bytes tx", "bytes rx", "wall ms");
+
+  bootToFirstUplink("boot OTAA -> first uplink", RN2483, true, -1);
+  bootToFirstUplink("boot ABP -> first uplink", RN2483, false, -1);
+  bootP2P();
+  p2pProfileSwitch(true);
+  p2pProfileSwitch(false);
+  p2pCollector(false);
+  p2pCollector(true);
+  p2pRing(1000);
+  p2pRing(5000);
+  bootToFirstUplink("boot OTAA + SINGLE_CHANNEL_EU", RN2483, true, SINGLE_CHANNEL_EU);
+  bootToFirstUplink("boot OTAA + TTN_EU", RN2483, true, TTN_EU);
+  bootToFirstUplink("boot OTAA + DEFAULT_EU", RN2483, true, DEFAULT_EU);
+  bootToFirstUplink("boot RN2903 OTAA + TTN_US", RN2903, true, TTN_US);
+  bootToFirstUplink("boot RN2903 ABP + TTN_US", RN2903, false, TTN_US);
+  warmBoot("warm boot OTAA (MCU reset)", true, false);
+  warmBoot("warm boot ABP (MCU reset)", false, false);
+  warmBoot("warm boot ABP (module restart)", false, true);
+  commandRate();
+  uplinkBytes();
+  autobaudSync();
+  sleepCycle(false);
+  sleepCycle(true);
+  fastLink(RN2XX3_DEFAULT_BAUD);
+  fastLink(115200);
+  fastLink(460800);
+  dutyCycleBound();
+  dataRateControl(false);
+  dataRateControl(true);
+  queuedTelemetry(false);
+  queuedTelemetry(true);
+  downlinkBurst(false);
+  downlinkBurst(true);
+  simulatedHour();
+  return 0;
+}
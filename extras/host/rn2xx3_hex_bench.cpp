@@ -0,0 +1,153 @@
+/*
+ * Microbenchmark of the base16 codec against the sprintf and strtoul
+ * conversions it replaced.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_hex.h"
+
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+
+// Encoding as done before, one sprintf per byte
+static void sprintfEncode(char *out, const uint8_t *data, size_t length)
+{
+  char buffer[3];
+  for (size_t i = 0; i < length; i++)
+  {
+    sprintf(buffer, "%02X", data[i]);
+    memcpy(&out[i * 2], buffer, 2);
+  }
+}
+
+// Decoding as done before, one strtoul per byte
+static void strtoulDecode(uint8_t *out, const char *hex, size_t hexLength)
+{
+  for (size_t i = 0; i < hexLength / 2; i++)
+  {
+    char toDo[3];
+    toDo[0] = hex[i * 2];
+    toDo[1] = hex[i * 2 + 1];
+    toDo[2] = '\0';
+    out[i] = strtoul(toDo, 0, 16);
+  }
+}
+
+static double nsPerByte(std::chrono::steady_clock::time_point start, double bytes)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / bytes;
+}
+
+static bool check()
+{
+  uint8_t data[256];
+  char hex[512];
+  char reference[512];
+  uint8_t decoded[256];
+  for (int i = 0; i < 256; i++)
+    data[i] = i * 37 + 11;
+
+  // Every length, so every tail of the block conversions is covered
+  for (size_t length = 0; length <= sizeof(data); length++)
+  {
+    rn2xx3_hex::encode(hex, data, length);
+    sprintfEncode(reference, data, length);
+    if (memcmp(hex, reference, length * 2) != 0)
+      return false;
+    if (!rn2xx3_hex::decode(decoded, hex, length * 2) || memcmp(decoded, data, length) != 0)
+      return false;
+    rn2xx3_hex::encode(hex, data, length, true);
+    if (!rn2xx3_hex::decode(decoded, hex, length * 2) || memcmp(decoded, data, length) != 0)
+      return false;
+  }
+
+  // Every invalid character at every position of a block is rejected
+  for (int c = 0; c < 256; c++)
+  {
+    if (rn2xx3_hex::nibble(c) >= 0)
+      continue;
+    for (size_t position = 0; position < 70; position++)
+    {
+      rn2xx3_hex::encode(hex, data, 35);
+      hex[position] = c;
+      if (rn2xx3_hex::decode(decoded, hex, 70))
+        return false;
+    }
+  }
+  if (rn2xx3_hex::decode(decoded, "ABC", 3))
+    return false;
+
+  // In place and in pieces
+  memcpy(decoded, data, 100);
+  rn2xx3_hex::encodeInPlace(decoded, 50);
+  rn2xx3_hex::encode(hex, data, 50);
+  if (memcmp(decoded, hex, 100) != 0 || rn2xx3_hex::decodeInPlace(hex, 100) != 50 || memcmp(hex, data, 50) != 0)
+    return false;
+
+  rn2xx3_hex::encode(hex, data, 100);
+  rn2xx3_hex::decoder decoder;
+  size_t written = 0;
+  for (size_t offset = 0; offset < 200; offset += 7)
+    written += decoder.write(decoded + written, hex + offset, offset + 7 <= 200 ? 7 : 200 - offset);
+  return written == 100 && decoder.finish() && memcmp(decoded, data, 100) == 0;
+}
+
+int main()
+{
+  bool ok = check();
+
+  // A typical uplink payload
+  const size_t length = 51;
+  const int iterations = 200000;
+  uint8_t data[length];
+  char hex[length * 2];
+  uint8_t decoded[length];
+  for (size_t i = 0; i < length; i++)
+    data[i] = rand();
+
+  unsigned long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    data[0] = n;
+    sprintfEncode(hex, data, length);
+    checksum += hex[1];
+  }
+  double sprintfNs = nsPerByte(start, (double)iterations * length);
+
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    data[0] = n;
+    rn2xx3_hex::encode(hex, data, length);
+    checksum += hex[1];
+  }
+  double encodeNs = nsPerByte(start, (double)iterations * length);
+
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    hex[0] = "0123456789ABCDEF"[n & 15];
+    strtoulDecode(decoded, hex, sizeof(hex));
+    checksum += decoded[0];
+  }
+  double strtoulNs = nsPerByte(start, (double)iterations * length);
+
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    hex[0] = "0123456789ABCDEF"[n & 15];
+    rn2xx3_hex::decode(decoded, hex, sizeof(hex));
+    checksum += decoded[0];
+  }
+  double decodeNs = nsPerByte(start, (double)iterations * length);
+
+  printf("%-24s %8.2f ns/byte\n", "sprintf encode", sprintfNs);
+  printf("%-24s %8.2f ns/byte  %.0fx\n", "rn2xx3_hex::encode", encodeNs, sprintfNs / encodeNs);
+  printf("%-24s %8.2f ns/byte\n", "strtoul decode", strtoulNs);
+  printf("%-24s %8.2f ns/byte  %.0fx\n", "rn2xx3_hex::decode", decodeNs, strtoulNs / decodeNs);
+  printf("checksum %lu%s\n", checksum, ok ? "" : " MISMATCH");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/*
+ * The deferred logger, built with RN2XX3_LOG_LEVEL at debug: the radio
+ * timing is the same whether the log is flushed while idle or not at all,
+ * and storing a record costs nanoseconds.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+#include "rn2xx3_sim.h"
+
+#include <chrono>
+
+static const char *DEV_ADDR = "0203FFEE";
+static const char *APP_SKEY = "8D7FFEF938589D95AAD928C2E2E7E48F";
+static const char *NWK_SKEY = "AE17E567AECC8787F749A62F5541D522";
+
+// A debug port that counts what it is given
+class LineCounter : public Print
+{
+public:
+  unsigned long lines = 0;
+  unsigned long bytes = 0;
+
+  size_t write(uint8_t c)
+  {
+    bytes++;
+    if (c == '\n')
+      lines++;
+    return 1;
+  }
+  using Print::write;
+};
+
+// Start on a whole second of the virtual clock, so runs can be compared
+static void alignClock()
+{
+  hostAdvance(1000000 - hostMicros() % 1000000);
+}
+
+// Ten uplinks with a downlink in between; returns the virtual time taken
+static uint64_t uplinks(rn2xx3 &lora, rn2xx3_sim &sim)
+{
+  uint64_t start = hostMicros();
+  for (int i = 0; i < 10; i++)
+  {
+    if (i == 4)
+      sim.queueDownlink(1, "01020304");
+    lora.tx("hello");
+    for (int n = 0; n < 100; n++)
+      lora.poll();
+  }
+  return hostMicros() - start;
+}
+
+int main()
+{
+  bool ok = true;
+
+  // Flushed from poll() while idle
+  alignClock();
+  rn2xx3_sim simIdle(RN2483);
+  rn2xx3 idle(simIdle);
+  LineCounter idleOut;
+  idle.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  idle.flushLog(idleOut);
+  idleOut.lines = 0;
+  idle.setLogOutput(&idleOut);
+  uint64_t idleUs = uplinks(idle, simIdle);
+  unsigned long idleLines = idleOut.lines;
+
+  // Only flushed at the end
+  alignClock();
+  rn2xx3_sim simLate(RN2483);
+  rn2xx3 late(simLate);
+  LineCounter lateOut;
+  late.initABP(DEV_ADDR, APP_SKEY, NWK_SKEY);
+  late.flushLog(lateOut);
+  lateOut.lines = 0;
+  uint64_t lateUs = uplinks(late, simLate);
+  late.flushLog(lateOut);
+  idle.flushLog(idleOut);
+
+  // Both saw the same events, the late one lost the oldest
+  ok = idleUs == lateUs && ok;
+  ok = idleLines > 0 && idleOut.lines == lateOut.lines + late.getLostLogRecords() && ok;
+  printf("%-32s %12.1f ms, %lu lines while idle\n", "flushed from poll()", idleUs / 1000.0, idleLines);
+  printf("%-32s %12.1f ms, %lu lines, %lu lost\n", "flushed at the end", lateUs / 1000.0, lateOut.lines,
+         late.getLostLogRecords());
+
+  // The ring keeps the newest records when it is not flushed in time
+  rn2xx3_log log;
+  for (uint32_t i = 0; i < RN2XX3_LOG_ENTRIES + 5; i++)
+    log.push(rn2xx3_log::TX_SENT, 1, i);
+  rn2xx3_log_record record;
+  ok = log.lost() == 5 && log.pop(record) && record.value == 5 && record.event == rn2xx3_log::TX_SENT && ok;
+
+  const int iterations = 10000000;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    log.push(rn2xx3_log::RECEIVED, i & 0xFF, i);
+  double pushNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  log.pop(record);
+  printf("%-32s %12.2f ns/record\n", "push", pushNs);
+  printf("checksum %lu%s\n", (unsigned long)record.value, ok ? "" : " MISMATCH");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+/*
+ * Several simulated RN2483 modules driven by rn2xx3_manager, against the
+ * same traffic on a single module: a 20 byte reading every 3 s at DR5,
+ * more than the duty cycle of one module allows.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+#include "rn2xx3_manager.h"
+#include "rn2xx3_sim.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+static const char *DEV_ADDR = "0203FFEE";
+static const char *APP_SKEY = "8D7FFEF938589D95AAD928C2E2E7E48F";
+static const char *NWK_SKEY = "AE17E567AECC8787F749A62F5541D522";
+
+static const unsigned long READINGS = 200;
+
+static bool run(uint8_t count)
+{
+  std::vector<std::unique_ptr<rn2xx3_sim> > sims;
+  std::vector<std::unique_ptr<rn2xx3> > radios;
+  rn2xx3_manager manager;
+  bool ok = true;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    sims.emplace_back(new rn2xx3_sim(RN2483));
+    radios.emplace_back(new rn2xx3(*sims.back()));
+    ok = radios.back()->initABP(DEV_ADDR, APP_SKEY, NWK_SKEY) && ok;
+    ok = radios.back()->setFrequencyPlan(TTN_EU) && ok;
+    radios.back()->setDR(5);
+    ok = manager.add(*radios.back()) && ok;
+  }
+
+  // Readings for 10 minutes, waiting in the application until a radio is free
+  std::chrono::steady_clock::time_point startWall = std::chrono::steady_clock::now();
+  manager.resetUsage();
+  unsigned long start = millis();
+  unsigned long next = start;
+  unsigned long readings = 0, sent = 0, maxBacklog = 0;
+  uint8_t data[20] = {0};
+  while (readings < READINGS || sent < readings || manager.poll())
+  {
+    if (readings < READINGS && (long)(millis() - next) >= 0)
+    {
+      readings++;
+      next += 3000;
+    }
+    while (sent < readings && manager.send(data, sizeof(data)) >= 0)
+      sent++;
+    if (readings - sent > maxBacklog)
+      maxBacklog = readings - sent;
+    manager.poll();
+    delay(10);
+  }
+  double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startWall).count();
+
+  unsigned long frames = 0, failures = 0;
+  printf("%u radio%s: %lu readings sent in %.1f min, up to %lu waiting, %.1f ms wall\n", count,
+         count > 1 ? "s" : "", READINGS, (millis() - start) / 60000.0, maxBacklog, wallMs);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    rn2xx3_radio_usage usage;
+    manager.getUsage(i, usage);
+    frames += usage.frames;
+    failures += usage.failures;
+    printf("    radio %u: %3lu frames, %lu failed, busy %4.1f%%\n", i, usage.frames, usage.failures,
+           100.0 * usage.busyMs / usage.periodMs);
+  }
+  ok = frames == READINGS && failures == 0 && ok;
+  if (!ok)
+    printf("    FAILED\n");
+  return ok;
+}
+
+int main()
+{
+  bool ok = run(1);
+  ok = run(3) && ok;
+  return ok ? 0 : 1;
+}
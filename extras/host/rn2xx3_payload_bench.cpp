@@ -0,0 +1,147 @@
+/*
+ * Round trip checks of the schema packer and the payload size and time on
+ * air it saves over sending readings as text.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_airtime.h"
+#include "rn2xx3_payload.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// The layout of the TTN Mapper binary examples
+static const rn2xx3_field MAPPER[] PROGMEM = {
+    {24, false, 16777215 / 180.0, -90},
+    {24, false, 16777215 / 360.0, -180},
+    {16, true, 1, 0},
+    {8, false, 10, 0}};
+
+// Cayenne LPP temperature on channel 1 and humidity on channel 2
+static const rn2xx3_field LPP[] PROGMEM = {
+    {8, false, 0, 1},
+    {8, false, 0, 103},
+    {16, true, 10, 0},
+    {8, false, 0, 2},
+    {8, false, 0, 104},
+    {8, false, 2, 0}};
+
+// Odd widths that straddle byte boundaries
+static const rn2xx3_field ODD[] PROGMEM = {
+    {3, false, 1, 0},
+    {13, true, 1, 0},
+    {1, false, 1, 0},
+    {32, true, 1, 0},
+    {7, false, 1, 0}};
+
+static bool near(double a, double b, double tolerance)
+{
+  return fabs(a - b) <= tolerance;
+}
+
+static bool checkMapper()
+{
+  uint8_t buffer[9];
+  for (double lat = -90; lat <= 90; lat += 7.31)
+  {
+    for (double lon = -180; lon <= 180; lon += 13.7)
+    {
+      rn2xx3_packer packer(MAPPER, 4, buffer, sizeof(buffer));
+      packer.add(lat).add(lon).add(-lat * 10).add(lon / 100 + 2);
+      if (packer.overflowed() || packer.length() != 9)
+        return false;
+
+      rn2xx3_unpacker unpacker(MAPPER, 4, buffer, sizeof(buffer));
+      if (!near(unpacker.next(), lat, 180 / 16777215.0) || !near(unpacker.next(), lon, 360 / 16777215.0))
+        return false;
+      if (!near(unpacker.next(), -lat * 10, 0.5) || !near(unpacker.next(), fmax(lon / 100 + 2, 0), 0.05))
+        return false;
+      if (unpacker.available() || unpacker.overflowed())
+        return false;
+    }
+  }
+
+  // The byte layout decoded by the TTN Mapper payload function
+  rn2xx3_packer packer(MAPPER, 4, buffer, sizeof(buffer));
+  packer.add(-90).add(180).add(-2).add(25.5);
+  static const uint8_t expected[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xFF};
+  return memcmp(buffer, expected, sizeof(expected)) == 0;
+}
+
+static bool checkLpp()
+{
+  uint8_t buffer[7];
+  rn2xx3_packer packer(LPP, 6, buffer, sizeof(buffer));
+  packer.add(-12.3).add(55.5);
+  static const uint8_t expected[] = {0x01, 0x67, 0xFF, 0x85, 0x02, 0x68, 0x6F};
+  if (packer.overflowed() || packer.length() != 7 || memcmp(buffer, expected, 7) != 0)
+    return false;
+
+  rn2xx3_unpacker unpacker(LPP, 6, buffer, sizeof(buffer));
+  return unpacker.next() == 1 && unpacker.next() == 103 && near(unpacker.next(), -12.3, 1e-9) &&
+         unpacker.next() == 2 && unpacker.next() == 104 && unpacker.next() == 55.5 && !unpacker.available();
+}
+
+static bool checkOdd()
+{
+  uint8_t buffer[8];
+  if (rn2xx3_packer::size(ODD, 5) != 7)
+    return false;
+
+  rn2xx3_packer packer(ODD, 5, buffer, sizeof(buffer));
+  packer.add(5).add(-4096).add(1).add(-2147483647.0 - 1).add(200);
+  if (packer.overflowed() || packer.length() != 7)
+    return false;
+
+  // The last value saturates at 127
+  rn2xx3_unpacker unpacker(ODD, 5, buffer, sizeof(buffer));
+  if (unpacker.next() != 5 || unpacker.next() != -4096 || unpacker.next() != 1 ||
+      unpacker.next() != -2147483648.0 || unpacker.next() != 127)
+    return false;
+
+  // Too small a buffer, too many values and a short payload are reported
+  rn2xx3_packer small(ODD, 5, buffer, 6);
+  small.add(1).add(1).add(1).add(1).add(1);
+  rn2xx3_packer extra(ODD, 1, buffer, sizeof(buffer));
+  extra.add(1).add(2);
+  rn2xx3_unpacker shortPayload(ODD, 5, buffer, 2);
+  shortPayload.next();
+  shortPayload.next();
+  shortPayload.next();
+  return small.overflowed() && extra.overflowed() && shortPayload.overflowed();
+}
+
+int main()
+{
+  bool ok = checkMapper() && checkLpp() && checkOdd();
+
+  // A fix as the examples would send it as text
+  char text[64];
+  int textLength = snprintf(text, sizeof(text), "%.6f,%.6f,%d,%.1f", 52.370216, 4.895168, 12, 1.2);
+
+  printf("%-24s %8s %12s %12s\n", "TTN Mapper fix", "bytes", "DR0 us", "DR5 us");
+  printf("%-24s %8d %12lu %12lu\n", "text", textLength,
+         (unsigned long)rn2xx3_airtime::lorawan(false, 0, textLength),
+         (unsigned long)rn2xx3_airtime::lorawan(false, 5, textLength));
+  printf("%-24s %8d %12lu %12lu\n", "rn2xx3_packer", 9,
+         (unsigned long)rn2xx3_airtime::lorawan(false, 0, 9),
+         (unsigned long)rn2xx3_airtime::lorawan(false, 5, 9));
+
+  const int iterations = 1000000;
+  uint8_t buffer[9];
+  unsigned long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    rn2xx3_packer packer(MAPPER, 4, buffer, sizeof(buffer));
+    packer.add(52.370216 + n * 1e-7).add(4.895168).add(12).add(1.2);
+    checksum += buffer[2];
+  }
+  double packNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  printf("%-24s %8.2f ns/fix\n", "pack", packNs);
+  printf("checksum %lu%s\n", checksum, ok ? "" : " MISMATCH");
+  return ok ? 0 : 1;
+}
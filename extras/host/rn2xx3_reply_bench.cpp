@@ -0,0 +1,157 @@
+/*
+ * Microbenchmark of the reply classifier against the String based
+ * classification it replaced, on recorded RN2xx3 reply lines.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_reply.h"
+
+#include <chrono>
+
+static const char *LINES[] = {
+    "ok",
+    "mac_tx_ok",
+    "mac_rx 1 54657374696E6720313233",
+    "mac_rx 42 0102030405060708090A0B0C0D0E0F10",
+    "radio_tx_ok",
+    "radio_rx  54657374696E6720313233",
+    "radio_err",
+    "busy",
+    "no_free_ch",
+    "not_joined",
+    "invalid_param",
+    "invalid_data_len",
+    "mac_err",
+    "mac_paused",
+    "silent",
+    "frame_counter_err_rejoin_needed",
+    "accepted",
+    "denied",
+    "keys_not_init",
+    "RN2483 1.0.5 Oct 31 2018 15:06:52",
+    "0004A30B001A2B3C",
+    "4294967245",
+};
+
+#define LINE_COUNT (sizeof(LINES) / sizeof(LINES[0]))
+
+// The classification as done before, including the payload extraction
+static int stringClassify(const String &receivedData, String &payload)
+{
+#define MATCH_STRING(S, V)            \
+  if (receivedData.startsWith(F(#S))) \
+    return (V);
+
+  if (receivedData.length() != 0)
+  {
+    switch (receivedData[0])
+    {
+    case 'a':
+      MATCH_STRING(accepted, rn2xx3_reply::accepted);
+      break;
+    case 'b':
+      MATCH_STRING(busy, rn2xx3_reply::busy);
+      break;
+    case 'd':
+      MATCH_STRING(denied, rn2xx3_reply::denied);
+      break;
+    case 'f':
+      MATCH_STRING(frame_counter_err_rejoin_needed, rn2xx3_reply::frame_counter_err_rejoin_needed);
+      break;
+    case 'i':
+      MATCH_STRING(invalid_data_len, rn2xx3_reply::invalid_data_len);
+      MATCH_STRING(invalid_param, rn2xx3_reply::invalid_param);
+      break;
+    case 'k':
+      MATCH_STRING(keys_not_init, rn2xx3_reply::keys_not_init);
+      break;
+    case 'm':
+      MATCH_STRING(mac_err, rn2xx3_reply::mac_err);
+      MATCH_STRING(mac_paused, rn2xx3_reply::mac_paused);
+      if (receivedData.startsWith(F("mac_rx")))
+      {
+        payload = receivedData.substring(receivedData.indexOf(' ', 7) + 1);
+        return rn2xx3_reply::mac_rx;
+      }
+      MATCH_STRING(mac_tx_ok, rn2xx3_reply::mac_tx_ok);
+      break;
+    case 'n':
+      MATCH_STRING(no_free_ch, rn2xx3_reply::no_free_ch);
+      MATCH_STRING(not_joined, rn2xx3_reply::not_joined);
+      break;
+    case 'o':
+      MATCH_STRING(ok, rn2xx3_reply::ok);
+      break;
+    case 'r':
+      MATCH_STRING(radio_err, rn2xx3_reply::radio_err);
+      MATCH_STRING(radio_tx_ok, rn2xx3_reply::radio_tx_ok);
+      if (receivedData.startsWith(F("radio_rx")))
+      {
+        payload = receivedData.substring(receivedData.indexOf(' ', 1) + 1);
+        payload.trim();
+        return rn2xx3_reply::radio_rx;
+      }
+      break;
+    case 's':
+      MATCH_STRING(silent, rn2xx3_reply::silent);
+      break;
+    }
+  }
+#undef MATCH_STRING
+  return rn2xx3_reply::UNKNOWN;
+}
+
+int main()
+{
+  const int iterations = 200000;
+  uint16_t lengths[LINE_COUNT];
+  bool ok = true;
+
+  // Both must agree on every recorded line
+  for (size_t i = 0; i < LINE_COUNT; i++)
+  {
+    lengths[i] = strlen(LINES[i]);
+    String payload;
+    int expected = stringClassify(String(LINES[i]), payload);
+    rn2xx3_reply reply;
+    reply.parse(LINES[i], lengths[i]);
+    std::string parsed(LINES[i] + reply.payloadOffset, reply.payloadLength);
+    if (reply.type != expected || parsed != payload.c_str())
+    {
+      printf("MISMATCH on \"%s\": %d/%d \"%s\"/\"%s\"\n", LINES[i], reply.type, expected, parsed.c_str(), payload.c_str());
+      ok = false;
+    }
+  }
+
+  unsigned long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    for (size_t i = 0; i < LINE_COUNT; i++)
+    {
+      // A received line used to arrive as a String
+      String line(LINES[i]);
+      String payload;
+      checksum += stringClassify(line, payload) + payload.length();
+    }
+  }
+  double stringNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (int n = 0; n < iterations; n++)
+  {
+    for (size_t i = 0; i < LINE_COUNT; i++)
+    {
+      rn2xx3_reply reply;
+      checksum += reply.parse(LINES[i], lengths[i]) + reply.payloadLength;
+    }
+  }
+  double replyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  double lines = (double)iterations * LINE_COUNT;
+  printf("%-36s %8.1f ns/line\n", "String startsWith + substring", stringNs / lines);
+  printf("%-36s %8.1f ns/line\n", "rn2xx3_reply perfect hash", replyNs / lines);
+  printf("speedup %.1fx (checksum %lu)%s\n", stringNs / replyNs, checksum, ok ? "" : " MISMATCH");
+  return ok ? 0 : 1;
+}
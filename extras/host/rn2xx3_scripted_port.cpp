@@ -0,0 +1,54 @@
+/*
+ * Serial ports for rn2xx3_transport_bench, see rn2xx3_scripted_port.h.
+ *
+ */
+
+#include "rn2xx3_scripted_port.h"
+
+#include <string.h>
+
+void scripted_link::queue(const char *line)
+{
+  if (_replyPos == _replyLength)
+    _replyPos = _replyLength = 0;
+  size_t length = strlen(line);
+  memcpy(_reply + _replyLength, line, length);
+  _replyLength += length;
+}
+
+void scripted_link::answer()
+{
+  if (_lineLength > 7 && memcmp(_line, "mac tx ", 7) == 0)
+    queue("ok\r\nmac_tx_ok\r\n");
+  else
+    queue("ok\r\n");
+  _lineLength = 0;
+}
+
+size_t ScriptedPort::write(uint8_t c)
+{
+  link.put(c);
+  return 1;
+}
+
+size_t ScriptedPort::write(const uint8_t *buffer, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    link.put(buffer[i]);
+  return size;
+}
+
+int ScriptedPort::available()
+{
+  return link.available();
+}
+
+int ScriptedPort::read()
+{
+  return link.get();
+}
+
+int ScriptedPort::peek()
+{
+  return link.peek();
+}
@@ -0,0 +1,89 @@
+/*
+ * Serial ports for rn2xx3_transport_bench that answer every uplink right
+ * away, and every other line with "ok".
+ *
+ * Both ports do the same work per byte in scripted_link. ScriptedPort is
+ * a Stream whose members are defined in rn2xx3_scripted_port.cpp, so a
+ * call through a Stream can not be resolved at compile time, as with the
+ * serial ports of the Arduino cores. DirectPort is final with its members
+ * in this header, as a port class written for rn2xx3_t would be.
+ *
+ */
+
+#ifndef rn2xx3_scripted_port_h
+#define rn2xx3_scripted_port_h
+
+#include "Arduino.h"
+
+class scripted_link
+{
+public:
+  unsigned long written = 0;
+  uint32_t checksum = 0;
+
+  void put(uint8_t c)
+  {
+    written++;
+    checksum = checksum * 31 + c;
+    if (_lineLength < sizeof(_line))
+      _line[_lineLength++] = c;
+    if (c == '\n')
+      answer();
+  }
+
+  int available() const { return _replyLength - _replyPos; }
+  int get() { return _replyPos < _replyLength ? _reply[_replyPos++] : -1; }
+  int peek() const { return _replyPos < _replyLength ? _reply[_replyPos] : -1; }
+
+  // Queue a line to read, as if the RN2xx3 sent it
+  void queue(const char *line);
+
+private:
+  uint8_t _line[600];
+  size_t _lineLength = 0;
+  char _reply[1200];
+  size_t _replyPos = 0;
+  size_t _replyLength = 0;
+
+  void answer();
+};
+
+class ScriptedPort : public Stream
+{
+public:
+  scripted_link link;
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+};
+
+class DirectPort final : public Stream
+{
+public:
+  scripted_link link;
+
+  size_t write(uint8_t c) override
+  {
+    link.put(c);
+    return 1;
+  }
+
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    for (size_t i = 0; i < size; i++)
+      link.put(buffer[i]);
+    return size;
+  }
+  using Print::write;
+
+  int available() override { return link.available(); }
+  int read() override { return link.get(); }
+  int peek() override { return link.peek(); }
+};
+
+#endif
@@ -0,0 +1,891 @@
+/*
+ * Simulated Microchip RN2483/RN2903 module for host builds.
+ *
+ */
+
+#include "rn2xx3_sim.h"
+
+#include <math.h>
+#include <sstream>
+
+// Time the module takes to answer a simple command
+#define SIM_PROCESSING_US 1000ULL
+// Bytes the host UART can buffer before a write blocks
+#define SIM_HOST_TX_BUFFER 64
+
+static bool isHex(const std::string &s, size_t length = 0)
+{
+  if (s.empty() || (length && s.size() != length))
+    return false;
+  for (size_t i = 0; i < s.size(); i++)
+  {
+    if (!isxdigit((unsigned char)s[i]))
+      return false;
+  }
+  return true;
+}
+
+rn2xx3_sim::rn2xx3_sim(RN2xx3_t model, unsigned long baud)
+    : _model(model), _inFreeAt(0), _outFreeAt(0), _joined(false), _paused(false),
+      _silent(false), _asleep(false), _joinAccept(true), _busyUntil(0), _rxId(0),
+      _rxArmed(false), _sleepId(0), _snr(8), _margin(20), _gateways(1), _uplinkSnrSet(false), _uplinkSnr(0), _seed(2483),
+      _commands(0), _uplinks(0), _bytesFromHost(0), _bytesToHost(0), _airtimeUs(0)
+{
+  setBaud(baud);
+  macReset();
+  _saved = _mac;
+  radioReset();
+}
+
+void rn2xx3_sim::setBaud(unsigned long baud)
+{
+  // 8N1: 10 bits per byte
+  _byteUs = 10e6 / baud;
+}
+
+uint32_t rn2xx3_sim::random()
+{
+  _seed = _seed * 1103515245 + 12345;
+  return _seed >> 8;
+}
+
+void rn2xx3_sim::macReset()
+{
+  _mac.deveui = _mac.appeui = _mac.appkey = "";
+  _mac.nwkskey = _mac.appskey = "";
+  _mac.devaddr = "00000000";
+  _mac.upctr = _mac.dnctr = 0;
+  _mac.adr = _mac.ar = false;
+  for (int ch = 0; ch < 72; ch++)
+  {
+    // RN2483: the three default channels. RN2903: everything.
+    _mac.status[ch] = _model == RN2903 || ch < 3;
+    _chFreeAt[ch] = 0;
+  }
+  for (int ch = 0; ch < 16; ch++)
+  {
+    _mac.dcycle[ch] = 302;
+    _mac.freq[ch] = 868100000 + ch * 200000;
+    _mac.drmin[ch] = 0;
+    _mac.drmax[ch] = 5;
+  }
+  if (_model == RN2903)
+  {
+    _mac.dr = 0;
+    _mac.pwridx = 5;
+    _mac.rx2dr = 8;
+    _mac.rx2freq = 923300000;
+  }
+  else
+  {
+    _mac.dr = 5;
+    _mac.pwridx = 1;
+    _mac.rx2dr = 0;
+    _mac.rx2freq = 869525000;
+  }
+  _joined = false;
+  _paused = false;
+  _silent = false;
+}
+
+void rn2xx3_sim::radioReset()
+{
+  _radio.mod = "lora";
+  _radio.freq = _model == RN2903 ? 923300000 : 868100000;
+  _radio.pwr = _model == RN2903 ? 2 : 1;
+  _radio.sf = 12;
+  _radio.bw = 125;
+  _radio.cr = 1;
+  _radio.prlen = 8;
+  _radio.sync = 0x34;
+  _radio.crc = true;
+  _radio.iqi = false;
+  _radio.wdt = 15000;
+  _rxArmed = false;
+}
+
+void rn2xx3_sim::powerCycle()
+{
+  sync();
+  _out.clear();
+  _events.clear();
+  _in.clear();
+  _downlinks.clear();
+  _asleep = false;
+  _busyUntil = 0;
+
+  macReset();
+  _mac = _saved;
+  radioReset();
+  reply(std::string(_model == RN2903 ? "RN2903" : "RN2483") + " 1.0.5 Oct 31 2018 15:06:52", hostMicros() + 100000);
+}
+
+void rn2xx3_sim::queueDownlink(uint8_t port, const char *hex)
+{
+  _downlinks.push_back(std::make_pair(port, std::string(hex)));
+}
+
+void rn2xx3_sim::receiveP2P(const char *hex, int snr, unsigned long atMs)
+{
+  frame_t frame;
+  frame.at = (uint64_t)atMs * 1000;
+  frame.hex = hex;
+  frame.snr = snr;
+  _air.push_back(frame);
+
+  if (_rxArmed && frame.at >= hostMicros())
+  {
+    unsigned id = _rxId;
+    schedule(frame.at, [this, id, frame]() {
+      if (!_rxArmed || _rxId != id)
+        return;
+      _rxArmed = false;
+      _snr = frame.snr;
+      reply("radio_rx  " + frame.hex, frame.at);
+    });
+  }
+}
+
+void rn2xx3_sim::setJoinAccept(bool accept)
+{
+  _joinAccept = accept;
+}
+
+void rn2xx3_sim::forceTxReply(const char *reply, unsigned count)
+{
+  while (count--)
+    _forced.push_back(reply);
+}
+
+void rn2xx3_sim::setLinkQuality(int snr, int margin, int gateways)
+{
+  _snr = snr;
+  _margin = margin;
+  _gateways = gateways;
+}
+
+void rn2xx3_sim::setUplinkSnr(int snr)
+{
+  _uplinkSnrSet = true;
+  _uplinkSnr = snr;
+}
+
+bool rn2xx3_sim::joined() const
+{
+  return _joined;
+}
+
+unsigned long rn2xx3_sim::commands() const
+{
+  return _commands;
+}
+
+unsigned long rn2xx3_sim::uplinks() const
+{
+  return _uplinks;
+}
+
+uint64_t rn2xx3_sim::airtimeUs() const
+{
+  return _airtimeUs;
+}
+
+unsigned long rn2xx3_sim::bytesFromHost() const
+{
+  return _bytesFromHost;
+}
+
+unsigned long rn2xx3_sim::bytesToHost() const
+{
+  return _bytesToHost;
+}
+
+void rn2xx3_sim::resetCounters()
+{
+  _commands = _uplinks = _bytesFromHost = _bytesToHost = 0;
+  _airtimeUs = 0;
+}
+
+uint64_t rn2xx3_sim::airtime(int sf, int bwKHz, int cr, int preamble, int payload, bool crc)
+{
+  // Semtech AN1200.13, explicit header
+  double tsym = (double)(1 << sf) / (bwKHz * 1000.0);
+  bool de = tsym > 0.016;
+  double tpreamble = (preamble + 4.25) * tsym;
+  double n = ceil((8.0 * payload - 4.0 * sf + 28 + 16 * crc) / (4.0 * (sf - 2 * de))) * (cr + 4);
+  double symbols = 8 + (n > 0 ? n : 0);
+  return (uint64_t)((tpreamble + symbols * tsym) * 1e6);
+}
+
+int rn2xx3_sim::channelCount() const
+{
+  return _model == RN2903 ? 72 : 16;
+}
+
+void rn2xx3_sim::dataRate(int dr, int &sf, int &bw) const
+{
+  if (_model == RN2903)
+  {
+    if (dr == 4 || dr >= 8)
+    {
+      sf = dr == 4 ? 8 : 20 - dr;
+      bw = 500;
+    }
+    else
+    {
+      sf = 10 - dr;
+      bw = 125;
+    }
+  }
+  else
+  {
+    sf = dr >= 6 ? 7 : 12 - dr;
+    bw = dr == 6 ? 250 : 125;
+  }
+}
+
+bool rn2xx3_sim::validDataRate(int dr) const
+{
+  if (_model == RN2903)
+    return (dr >= 0 && dr <= 4) || (dr >= 8 && dr <= 13);
+  return dr >= 0 && dr <= 7;
+}
+
+int rn2xx3_sim::maxPayload(int dr) const
+{
+  if (_model == RN2903)
+  {
+    static const int max[] = {11, 53, 125, 242, 242};
+    return dr <= 4 ? max[dr] : 242;
+  }
+  return dr <= 2 ? 51 : dr == 3 ? 115 : 222;
+}
+
+uint64_t rn2xx3_sim::lorawanAirtime(int dr, int payload) const
+{
+  int sf, bw;
+  dataRate(dr, sf, bw);
+  return airtime(sf, bw, 1, 8, payload + 13);
+}
+
+uint64_t rn2xx3_sim::rx2Window() const
+{
+  // The receiver stays open for a few symbols to detect a preamble
+  int sf, bw;
+  dataRate(_mac.rx2dr, sf, bw);
+  return (uint64_t)(8.0 * (1 << sf) / (bw * 1000.0) * 1e6);
+}
+
+void rn2xx3_sim::schedule(uint64_t at, std::function<void()> event)
+{
+  _events.insert(std::make_pair(at, event));
+}
+
+void rn2xx3_sim::reply(const std::string &line, uint64_t at)
+{
+  uint64_t t = at > _outFreeAt ? at : _outFreeAt;
+  std::string bytes = line + "\r\n";
+  for (size_t i = 0; i < bytes.size(); i++)
+  {
+    t += (uint64_t)_byteUs;
+    _out.push_back(std::make_pair(t, bytes[i]));
+  }
+  _outFreeAt = t;
+}
+
+void rn2xx3_sim::sync()
+{
+  while (!_events.empty() && _events.begin()->first <= hostMicros())
+  {
+    std::function<void()> event = _events.begin()->second;
+    _events.erase(_events.begin());
+    event();
+  }
+}
+
+uint64_t rn2xx3_sim::nextEventMicros()
+{
+  sync();
+  uint64_t next = UINT64_MAX;
+  if (!_events.empty())
+    next = _events.begin()->first;
+  if (!_out.empty() && _out.front().first < next)
+    next = _out.front().first;
+  return next;
+}
+
+int rn2xx3_sim::available()
+{
+  sync();
+  int n = 0;
+  for (size_t i = 0; i < _out.size() && _out[i].first <= hostMicros(); i++)
+    n++;
+  return n;
+}
+
+int rn2xx3_sim::read()
+{
+  if (!available())
+    return -1;
+  char c = _out.front().second;
+  _out.pop_front();
+  _bytesToHost++;
+  return (uint8_t)c;
+}
+
+int rn2xx3_sim::peek()
+{
+  if (!available())
+    return -1;
+  return (uint8_t)_out.front().second;
+}
+
+size_t rn2xx3_sim::write(uint8_t c)
+{
+  sync();
+  _bytesFromHost++;
+
+  // A write blocks once the UART buffer of the host is full
+  uint64_t now = hostMicros();
+  if (_inFreeAt > now + (uint64_t)(SIM_HOST_TX_BUFFER * _byteUs))
+    hostAdvance(_inFreeAt - now - (uint64_t)(SIM_HOST_TX_BUFFER * _byteUs));
+  now = hostMicros();
+  _inFreeAt = (_inFreeAt > now ? _inFreeAt : now) + (uint64_t)_byteUs;
+
+  if (_asleep)
+  {
+    // A break wakes the module up, everything else is lost
+    if (c == 0x00)
+    {
+      unsigned id = _sleepId;
+      uint64_t at = _inFreeAt;
+      schedule(at, [this, id, at]() {
+        if (!_asleep || _sleepId != id)
+          return;
+        _asleep = false;
+        reply("ok", at + SIM_PROCESSING_US);
+      });
+    }
+    return 1;
+  }
+
+  if (c == 0x00 || (c == 0x55 && _in.empty()))
+  {
+    // break and autobaud character
+    return 1;
+  }
+  if (c == '\r')
+    return 1;
+  if (c != '\n')
+  {
+    _in += (char)c;
+    return 1;
+  }
+
+  std::string command = _in;
+  _in.clear();
+  uint64_t at = _inFreeAt;
+  schedule(at, [this, command, at]() { process(command, at); });
+  return 1;
+}
+
+void rn2xx3_sim::process(const std::string &command, uint64_t at)
+{
+  _commands++;
+  if (_asleep)
+    return;
+
+  std::vector<std::string> args;
+  std::istringstream tokens(command);
+  std::string token;
+  while (tokens >> token)
+    args.push_back(token);
+
+  uint64_t done = at + SIM_PROCESSING_US;
+  std::string answer = "invalid_param";
+
+  if (args.size() >= 2 && args[0] == "sys")
+  {
+    if (args[1] == "get" && args.size() == 3)
+    {
+      if (args[2] == "ver")
+        answer = std::string(_model == RN2903 ? "RN2903" : "RN2483") + " 1.0.5 Oct 31 2018 15:06:52";
+      else if (args[2] == "hweui")
+        answer = "0004A30B001A2B3C";
+      else if (args[2] == "vdd")
+        answer = "3312";
+    }
+    else if (args[1] == "reset")
+    {
+      macReset();
+      _mac = _saved;
+      radioReset();
+      answer = std::string(_model == RN2903 ? "RN2903" : "RN2483") + " 1.0.5 Oct 31 2018 15:06:52";
+      done = at + 100000;
+    }
+    else if (args[1] == "sleep" && args.size() == 3)
+    {
+      unsigned long ms = strtoul(args[2].c_str(), NULL, 10);
+      if (ms < 100)
+      {
+        reply("invalid_param", done);
+        return;
+      }
+      _asleep = true;
+      unsigned id = ++_sleepId;
+      uint64_t wake = at + (uint64_t)ms * 1000;
+      schedule(wake, [this, id, wake]() {
+        if (!_asleep || _sleepId != id)
+          return;
+        _asleep = false;
+        reply("ok", wake);
+      });
+      return;
+    }
+  }
+  else if (args.size() >= 2 && args[0] == "mac")
+  {
+    if (args[1] == "reset")
+    {
+      macReset();
+      answer = "ok";
+    }
+    else if (args[1] == "set")
+    {
+      answer = macSet(args, at);
+    }
+    else if (args[1] == "get")
+    {
+      answer = macGet(args);
+    }
+    else if (args[1] == "save")
+    {
+      _saved = _mac;
+      answer = "ok";
+      done = at + 150000;
+    }
+    else if (args[1] == "pause")
+    {
+      _paused = true;
+      _rxArmed = false;
+      answer = "4294967245";
+    }
+    else if (args[1] == "resume")
+    {
+      _paused = false;
+      answer = "ok";
+    }
+    else if (args[1] == "forceENABLE")
+    {
+      _silent = false;
+      answer = "ok";
+    }
+    else if (args[1] == "join" && args.size() == 3)
+    {
+      macJoin(args[2], at);
+      return;
+    }
+    else if (args[1] == "tx")
+    {
+      macTx(args, at);
+      return;
+    }
+  }
+  else if (args.size() >= 2 && args[0] == "radio")
+  {
+    if (!_paused || (_rxArmed && args[1] != "rxstop"))
+    {
+      // The receiver only takes "radio rxstop" while it is on
+      answer = "busy";
+    }
+    else if (args[1] == "set")
+    {
+      answer = radioSet(args);
+    }
+    else if (args[1] == "get" && args.size() == 3 && args[2] == "snr")
+    {
+      answer = std::to_string(_snr);
+    }
+    else if (args[1] == "rxstop")
+    {
+      _rxArmed = false;
+      answer = "ok";
+    }
+    else if (args[1] == "tx" && args.size() == 3 && isHex(args[2]) && args[2].size() % 2 == 0)
+    {
+      uint64_t air = airtime(_radio.sf, _radio.bw, _radio.cr, _radio.prlen, args[2].size() / 2, _radio.crc);
+      uint64_t end = done + air;
+      _uplinks++;
+      _airtimeUs += air;
+      reply("ok", done);
+      reply("radio_tx_ok", end);
+      return;
+    }
+    else if (args[1] == "rx" && args.size() == 3)
+    {
+      reply("ok", done);
+      radioRx(done);
+      return;
+    }
+  }
+
+  reply(answer, done);
+}
+
+std::string rn2xx3_sim::macSet(const std::vector<std::string> &args, uint64_t at)
+{
+  (void)at;
+  if (args.size() < 4)
+    return "invalid_param";
+  const std::string &param = args[2];
+  const std::string &value = args[3];
+
+  if (param == "deveui" || param == "appeui")
+  {
+    if (!isHex(value, 16))
+      return "invalid_param";
+    (param == "deveui" ? _mac.deveui : _mac.appeui) = value;
+  }
+  else if (param == "appkey" || param == "nwkskey" || param == "appskey")
+  {
+    if (!isHex(value, 32))
+      return "invalid_param";
+    (param == "appkey" ? _mac.appkey : param == "nwkskey" ? _mac.nwkskey : _mac.appskey) = value;
+  }
+  else if (param == "devaddr")
+  {
+    if (!isHex(value, 8))
+      return "invalid_param";
+    _mac.devaddr = value;
+  }
+  else if (param == "dr")
+  {
+    int dr = atoi(value.c_str());
+    if (!validDataRate(dr))
+      return "invalid_param";
+    _mac.dr = dr;
+  }
+  else if (param == "pwridx")
+  {
+    _mac.pwridx = atoi(value.c_str());
+  }
+  else if (param == "adr" || param == "ar")
+  {
+    if (value != "on" && value != "off")
+      return "invalid_param";
+    (param == "adr" ? _mac.adr : _mac.ar) = value == "on";
+  }
+  else if (param == "rx2" && args.size() == 5)
+  {
+    _mac.rx2dr = atoi(value.c_str());
+    _mac.rx2freq = strtoul(args[4].c_str(), NULL, 10);
+  }
+  else if (param == "upctr" || param == "dnctr")
+  {
+    (param == "upctr" ? _mac.upctr : _mac.dnctr) = strtoul(value.c_str(), NULL, 10);
+  }
+  else if (param == "linkchk" || param == "retx" || param == "rxdelay1" || param == "sync")
+  {
+  }
+  else if (param == "ch" && args.size() >= 6)
+  {
+    int ch = atoi(args[4].c_str());
+    if (ch < 0 || ch >= channelCount())
+      return "invalid_param";
+    if (value == "status" && (args[5] == "on" || args[5] == "off"))
+      _mac.status[ch] = args[5] == "on";
+    else if (value == "dcycle" && _model == RN2483)
+      _mac.dcycle[ch] = strtoul(args[5].c_str(), NULL, 10);
+    else if (value == "freq" && _model == RN2483 && ch >= 3)
+      _mac.freq[ch] = strtoul(args[5].c_str(), NULL, 10);
+    else if (value == "drrange" && args.size() == 7)
+    {
+      if (ch < 16)
+      {
+        _mac.drmin[ch] = atoi(args[5].c_str());
+        _mac.drmax[ch] = atoi(args[6].c_str());
+      }
+    }
+    else
+      return "invalid_param";
+  }
+  else
+  {
+    return "invalid_param";
+  }
+  return "ok";
+}
+
+std::string rn2xx3_sim::macGet(const std::vector<std::string> &args)
+{
+  if (args.size() < 3)
+    return "invalid_param";
+  const std::string &param = args[2];
+  char buffer[16];
+
+  if (param == "status")
+  {
+    uint32_t status = (_joined ? 0x0001 : 0) | (_mac.ar ? 0x0010 : 0) | (_mac.adr ? 0x0020 : 0) |
+                      (_silent ? 0x0040 : 0) | (_paused ? 0x0080 : 0);
+    snprintf(buffer, sizeof(buffer), "%08X", status);
+    return buffer;
+  }
+  if (param == "deveui")
+    return _mac.deveui.empty() ? "0000000000000000" : _mac.deveui;
+  if (param == "appeui")
+    return _mac.appeui.empty() ? "0000000000000000" : _mac.appeui;
+  if (param == "devaddr")
+    return _mac.devaddr;
+  if (param == "upctr")
+    return std::to_string(_mac.upctr);
+  if (param == "dnctr")
+    return std::to_string(_mac.dnctr);
+  if (param == "dr")
+    return std::to_string(_mac.dr);
+  if (param == "pwridx")
+    return std::to_string(_mac.pwridx);
+  if (param == "adr")
+    return _mac.adr ? "on" : "off";
+  if (param == "ar")
+    return _mac.ar ? "on" : "off";
+  if (param == "mrgn")
+    return std::to_string(_margin);
+  if (param == "gwnb")
+    return std::to_string(_gateways);
+  return "invalid_param";
+}
+
+std::string rn2xx3_sim::radioSet(const std::vector<std::string> &args)
+{
+  if (args.size() < 4)
+    return "invalid_param";
+  const std::string &param = args[2];
+  const std::string &value = args[3];
+
+  if (param == "mod" && (value == "lora" || value == "fsk"))
+    _radio.mod = value;
+  else if (param == "freq")
+    _radio.freq = strtoul(value.c_str(), NULL, 10);
+  else if (param == "pwr")
+    _radio.pwr = atoi(value.c_str());
+  else if (param == "sf" && value.size() >= 3 && value.compare(0, 2, "sf") == 0 &&
+           atoi(value.c_str() + 2) >= 7 && atoi(value.c_str() + 2) <= 12)
+    _radio.sf = atoi(value.c_str() + 2);
+  else if (param == "bw" && (value == "125" || value == "250" || value == "500"))
+    _radio.bw = atoi(value.c_str());
+  else if (param == "cr" && value.size() == 3 && value.compare(0, 2, "4/") == 0 && value[2] >= '5' && value[2] <= '8')
+    _radio.cr = value[2] - '4';
+  else if (param == "prlen")
+    _radio.prlen = atoi(value.c_str());
+  else if (param == "sync")
+    _radio.sync = strtol(value.c_str(), NULL, 16);
+  else if ((param == "crc" || param == "iqi") && (value == "on" || value == "off"))
+    (param == "crc" ? _radio.crc : _radio.iqi) = value == "on";
+  else if (param == "wdt")
+    _radio.wdt = strtoul(value.c_str(), NULL, 10);
+  else if (param == "afcbw" || param == "rxbw" || param == "bitrate" || param == "fdev")
+    ;
+  else
+    return "invalid_param";
+  return "ok";
+}
+
+void rn2xx3_sim::macTx(const std::vector<std::string> &args, uint64_t at)
+{
+  uint64_t done = at + SIM_PROCESSING_US;
+
+  if (!_forced.empty())
+  {
+    std::string forced = _forced.front();
+    _forced.pop_front();
+    reply(forced, done);
+    return;
+  }
+
+  if (args.size() != 5 || (args[2] != "cnf" && args[2] != "uncnf"))
+  {
+    reply("invalid_param", done);
+    return;
+  }
+  int port = atoi(args[3].c_str());
+  const std::string &hex = args[4];
+  if (port < 1 || port > 223 || !isHex(hex) || hex.size() % 2)
+  {
+    reply("invalid_param", done);
+    return;
+  }
+  if (!_joined)
+  {
+    reply("not_joined", done);
+    return;
+  }
+  if (_silent)
+  {
+    reply("silent", done);
+    return;
+  }
+  if (_paused)
+  {
+    reply("mac_paused", done);
+    return;
+  }
+  if (at < _busyUntil)
+  {
+    reply("busy", done);
+    return;
+  }
+  if ((int)hex.size() / 2 > maxPayload(_mac.dr))
+  {
+    reply("invalid_data_len", done);
+    return;
+  }
+
+  // The module picks a random enabled channel that is free
+  std::vector<int> free;
+  for (int ch = 0; ch < channelCount(); ch++)
+  {
+    if (_mac.status[ch] && _chFreeAt[ch] <= at)
+      free.push_back(ch);
+  }
+  if (free.empty())
+  {
+    reply("no_free_ch", done);
+    return;
+  }
+  int ch = free[random() % free.size()];
+
+  uint64_t air = lorawanAirtime(_mac.dr, hex.size() / 2);
+  uint64_t txEnd = done + air;
+  if (_model == RN2483)
+    _chFreeAt[ch] = txEnd + air * _mac.dcycle[ch];
+
+  _mac.upctr++;
+  _uplinks++;
+  _airtimeUs += air;
+  if (_uplinkSnrSet)
+  {
+    // Demodulation floor of the SX1276: -7.5 dB at SF7, 2.5 dB lower per SF
+    int sf, bw;
+    dataRate(_mac.dr, sf, bw);
+    double floor = -7.5 - 2.5 * (sf - 7) + 10 * log10(bw / 125.0);
+    double margin = _uplinkSnr - floor;
+    _margin = margin < 0 ? 0 : (int)margin;
+    _gateways = margin < 0 ? 0 : 1;
+  }
+  reply("ok", done);
+  deliverDownlink(_mac.dr, txEnd);
+}
+
+void rn2xx3_sim::deliverDownlink(int dr, uint64_t txEnd)
+{
+  if (_downlinks.empty())
+  {
+    _busyUntil = txEnd + 2000000 + rx2Window();
+    reply("mac_tx_ok", _busyUntil);
+    return;
+  }
+
+  std::pair<uint8_t, std::string> downlink = _downlinks.front();
+  _downlinks.pop_front();
+  _mac.dnctr++;
+  _busyUntil = txEnd + 1000000 + lorawanAirtime(dr, downlink.second.size() / 2);
+  reply("mac_rx " + std::to_string(downlink.first) + " " + downlink.second, _busyUntil);
+
+  // With automatic reply the module acknowledges with an empty uplink,
+  // which opens new receive windows for the next queued downlink
+  if (_mac.ar && !_downlinks.empty())
+  {
+    uint64_t next = _busyUntil + SIM_PROCESSING_US;
+    _mac.upctr++;
+    _uplinks++;
+    _airtimeUs += lorawanAirtime(dr, 0);
+    deliverDownlink(dr, next + lorawanAirtime(dr, 0));
+  }
+}
+
+void rn2xx3_sim::macJoin(const std::string &mode, uint64_t at)
+{
+  uint64_t done = at + SIM_PROCESSING_US;
+
+  if (_paused)
+  {
+    reply("mac_paused", done);
+    return;
+  }
+  if (mode == "abp")
+  {
+    if (_mac.nwkskey.empty() || _mac.appskey.empty())
+    {
+      reply("keys_not_init", done);
+      return;
+    }
+    reply("ok", done);
+    _joined = true;
+    reply("accepted", done + SIM_PROCESSING_US);
+    return;
+  }
+  if (mode != "otaa")
+  {
+    reply("invalid_param", done);
+    return;
+  }
+  if (_mac.deveui.empty() || _mac.appeui.empty() || _mac.appkey.empty())
+  {
+    reply("keys_not_init", done);
+    return;
+  }
+
+  reply("ok", done);
+  uint64_t txEnd = done + lorawanAirtime(_mac.dr, 23 - 13);
+  _joined = false;
+  if (_joinAccept)
+  {
+    uint64_t accepted = txEnd + 5000000 + lorawanAirtime(_mac.dr, 17 - 13);
+    schedule(accepted, [this]() {
+      char devaddr[9];
+      snprintf(devaddr, sizeof(devaddr), "26%06X", (unsigned)(random() & 0xFFFFFF));
+      _mac.devaddr = devaddr;
+      _mac.upctr = _mac.dnctr = 0;
+      _joined = true;
+    });
+    _busyUntil = accepted;
+    reply("accepted", accepted);
+  }
+  else
+  {
+    _busyUntil = txEnd + 6000000 + rx2Window();
+    reply("denied", _busyUntil);
+  }
+}
+
+void rn2xx3_sim::radioRx(uint64_t at)
+{
+  unsigned id = ++_rxId;
+  _rxArmed = true;
+
+  // Frames that ended before the receiver was switched on are lost
+  for (size_t i = 0; i < _air.size(); i++)
+  {
+    if (_air[i].at < at)
+      continue;
+    frame_t frame = _air[i];
+    schedule(frame.at, [this, id, frame]() {
+      if (!_rxArmed || _rxId != id)
+        return;
+      _rxArmed = false;
+      _snr = frame.snr;
+      reply("radio_rx  " + frame.hex, frame.at);
+    });
+  }
+
+  if (_radio.wdt > 0)
+  {
+    uint64_t timeout = at + (uint64_t)_radio.wdt * 1000;
+    schedule(timeout, [this, id, timeout]() {
+      if (!_rxArmed || _rxId != id)
+        return;
+      _rxArmed = false;
+      reply("radio_err", timeout);
+    });
+  }
+}
@@ -0,0 +1,178 @@
+/*
+ * Simulated Microchip RN2483/RN2903 module for host builds.
+ *
+ * The simulator is a Stream that speaks the command protocol of the
+ * RN2xx3 at a given baud rate, with realistic timing: UART transfer time,
+ * LoRa time on air, the RX1/RX2 windows, join delays and duty cycle per
+ * channel. All timing runs on the virtual clock of the host Arduino.h.
+ *
+ */
+
+#ifndef rn2xx3_sim_h
+#define rn2xx3_sim_h
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+class rn2xx3_sim : public Stream, public HostEventSource
+{
+public:
+  rn2xx3_sim(RN2xx3_t model = RN2483, unsigned long baud = 57600);
+
+  // Stream
+  int available();
+  int read();
+  int peek();
+  size_t write(uint8_t c);
+  using Print::write;
+
+  // HostEventSource
+  uint64_t nextEventMicros();
+
+  /*
+     * Change the baud rate of the link, as after a successful autobaud.
+     */
+  void setBaud(unsigned long baud);
+
+  /*
+     * Queue a downlink, delivered in the RX1 window of the next uplink.
+     */
+  void queueDownlink(uint8_t port, const char *hex);
+
+  /*
+     * A P2P frame that ends at the given virtual time. It is only received
+     * if "radio rx" is active at that moment.
+     */
+  void receiveP2P(const char *hex, int snr, unsigned long atMs);
+
+  /*
+     * Whether the network accepts OTAA joins (default true).
+     */
+  void setJoinAccept(bool accept);
+
+  /*
+     * Reply to the next count tx commands with reply instead of
+     * handling them, like "busy" or "no_free_ch".
+     */
+  void forceTxReply(const char *reply, unsigned count = 1);
+
+  /*
+     * The SNR of downlinks and the result of link checks.
+     */
+  void setLinkQuality(int snr, int margin, int gateways);
+
+  /*
+     * Derive the link check result from the SNR at the gateway instead:
+     * the margin is what the data rate of the last uplink leaves, and no
+     * gateway answers when it is negative.
+     */
+  void setUplinkSnr(int snr);
+
+  /*
+     * Restart the module: everything not saved with "mac save" is lost.
+     */
+  void powerCycle();
+
+  bool joined() const;
+  unsigned long commands() const;
+  unsigned long uplinks() const;
+  // Total time on air of the uplinks in microseconds
+  uint64_t airtimeUs() const;
+  unsigned long bytesFromHost() const;
+  unsigned long bytesToHost() const;
+  void resetCounters();
+
+  /*
+     * Time on air in microseconds of a LoRa frame.
+     */
+  static uint64_t airtime(int sf, int bwKHz, int cr, int preamble, int payload, bool crc = true);
+
+private:
+  struct mac_t
+  {
+    std::string deveui, appeui, appkey, nwkskey, appskey, devaddr;
+    uint32_t upctr, dnctr;
+    int dr, pwridx, rx2dr;
+    uint32_t rx2freq;
+    bool adr, ar;
+    bool status[72];
+    unsigned dcycle[16];
+    uint32_t freq[16];
+    int drmin[16], drmax[16];
+  };
+
+  struct radio_t
+  {
+    std::string mod;
+    uint32_t freq;
+    int pwr, sf, bw, cr, prlen, sync;
+    bool crc, iqi;
+    unsigned long wdt;
+  };
+
+  struct frame_t
+  {
+    uint64_t at;
+    std::string hex;
+    int snr;
+  };
+
+  RN2xx3_t _model;
+  double _byteUs;
+
+  std::deque<std::pair<uint64_t, char> > _out;
+  std::multimap<uint64_t, std::function<void()> > _events;
+  std::string _in;
+  uint64_t _inFreeAt;
+  uint64_t _outFreeAt;
+
+  mac_t _mac, _saved;
+  radio_t _radio;
+  bool _joined, _paused, _silent, _asleep, _joinAccept;
+  uint64_t _busyUntil;
+  uint64_t _chFreeAt[72];
+  unsigned _rxId;
+  bool _rxArmed;
+  unsigned _sleepId;
+  int _snr, _margin, _gateways;
+  bool _uplinkSnrSet;
+  int _uplinkSnr;
+  std::deque<std::pair<uint8_t, std::string> > _downlinks;
+  std::vector<frame_t> _air;
+  std::deque<std::string> _forced;
+  uint32_t _seed;
+
+  unsigned long _commands, _uplinks, _bytesFromHost, _bytesToHost;
+  uint64_t _airtimeUs;
+
+  void sync();
+  void schedule(uint64_t at, std::function<void()> event);
+  void reply(const std::string &line, uint64_t at);
+  void process(const std::string &command, uint64_t at);
+  void macReset();
+  void radioReset();
+  uint32_t random();
+
+  int channelCount() const;
+  int maxPayload(int dr) const;
+  void dataRate(int dr, int &sf, int &bw) const;
+  bool validDataRate(int dr) const;
+  uint64_t lorawanAirtime(int dr, int payload) const;
+  uint64_t rx2Window() const;
+
+  std::string macSet(const std::vector<std::string> &args, uint64_t at);
+  std::string macGet(const std::vector<std::string> &args);
+  std::string radioSet(const std::vector<std::string> &args);
+  void macTx(const std::vector<std::string> &args, uint64_t at);
+  void deliverDownlink(int dr, uint64_t txEnd);
+  void macJoin(const std::string &mode, uint64_t at);
+  void radioRx(uint64_t at);
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Bytes per second through the driver on two serial ports doing the same
+ * work per byte: ScriptedPort called as a Stream by rn2xx3, and the final
+ * DirectPort called by rn2xx3_t, whose reads and writes are not virtual
+ * calls. See rn2xx3_scripted_port.h.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+#include "rn2xx3_hex.h"
+#include "rn2xx3_scripted_port.h"
+
+#include <chrono>
+#include <string.h>
+
+static const int UPLINKS = 100000;
+static const int PAYLOADS = 500000;
+static const int DOWNLINK_LINES = 200000;
+
+static double seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Uplinks of a 200 byte payload, hex-encoded as they are written
+template <class Driver>
+static double uplinks(Driver &lora, scripted_link &port, bool &ok)
+{
+  uint8_t payload[200];
+  for (size_t i = 0; i < sizeof(payload); i++)
+    payload[i] = i * 37 + 11;
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < UPLINKS; i++)
+    ok = lora.txBytes(payload, sizeof(payload)) == TX_SUCCESS && ok;
+  return port.written / seconds(start);
+}
+
+// The hex-encoding of 200 byte payloads on its own
+template <class Output>
+static double encodeAndWrite(Output &out, scripted_link &port)
+{
+  uint8_t payload[200];
+  for (size_t i = 0; i < sizeof(payload); i++)
+    payload[i] = i * 37 + 11;
+
+  unsigned long before = port.written;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < PAYLOADS; i++)
+  {
+    payload[0] = i;
+    rn2xx3_hex::print(out, payload, sizeof(payload));
+  }
+  return (port.written - before) / seconds(start);
+}
+
+// Downlink lines with 240 payload bytes, read through the line reader
+template <class Port>
+static double downlinks(Port &serial, scripted_link &port, bool &ok)
+{
+  char line[600] = "mac_rx 1 ";
+  uint8_t payload[240];
+  for (size_t i = 0; i < sizeof(payload); i++)
+    payload[i] = i * 13 + 5;
+  rn2xx3_hex::encode(line + 9, payload, sizeof(payload));
+  strcpy(line + 9 + 2 * sizeof(payload), "\r\n");
+  size_t length = strlen(line);
+
+  rn2xx3_line_reader reader;
+  unsigned long bytes = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < DOWNLINK_LINES; i++)
+  {
+    port.queue(line);
+    ok = reader.poll(serial) && reader.line().length == length - 2 && ok;
+    bytes += length;
+  }
+  return bytes / seconds(start);
+}
+
+int main()
+{
+  bool ok = true;
+
+  // rn2xx3 is compiled for Stream in rn2xx3.cpp, so every call is virtual
+  ScriptedPort streamPort;
+  rn2xx3 streamLora(streamPort);
+  double streamUp = uplinks(streamLora, streamPort.link, ok);
+  // Nor may the compiler see which Stream the helpers below are given
+  Stream *volatile stream = &streamPort;
+  double streamHex = encodeAndWrite(*stream, streamPort.link);
+  double streamDown = downlinks(*stream, streamPort.link, ok);
+
+  DirectPort directPort;
+  rn2xx3_t<DirectPort> directLora(directPort);
+  double directUp = uplinks(directLora, directPort.link, ok);
+  double directHex = encodeAndWrite(directPort, directPort.link);
+  double directDown = downlinks(directPort, directPort.link, ok);
+
+  ok = streamPort.link.checksum == directPort.link.checksum && ok;
+  printf("%-32s %15s %15s\n", "", "Stream", "rn2xx3_t");
+  printf("%-32s %10.1f MB/s %10.1f MB/s\n", "uplinks, encode and write", streamUp / 1e6, directUp / 1e6);
+  printf("%-32s %10.1f MB/s %10.1f MB/s\n", "payloads, encode and write", streamHex / 1e6, directHex / 1e6);
+  printf("%-32s %10.1f MB/s %10.1f MB/s\n", "downlink lines, read", streamDown / 1e6, directDown / 1e6);
+  printf("checksum %08lx%s\n", (unsigned long)directPort.link.checksum, ok ? "" : " MISMATCH");
+  return ok ? 0 : 1;
+}
@@ -1,343 +1,1161 @@
-/*
- * A library for controlling a Microchip RN2xx3 LoRa radio.
- *
- * @Author JP Meijers
- * @Author Nicolas Schteinschraber
- * @Date 18/12/2015
- *
- */
-
-#ifndef rn2xx3_h
-#define rn2xx3_h
-
-#include "Arduino.h"
-
-enum RN2xx3_t
-{
-  RN_NA = 0, // Not set
-  RN2903 = 2903,
-  RN2483 = 2483
-};
-
-enum FREQ_PLAN
-{
-  SINGLE_CHANNEL_EU,
-  TTN_EU,
-  TTN_US,
-  DEFAULT_EU
-};
-
-enum TX_RETURN_TYPE
-{
-  TX_FAIL = 0, // The transmission failed.
-               // If you sent a confirmed message and it is not acked,
-               // this will be the returned value.
-
-  TX_SUCCESS = 1, // The transmission was successful.
-                  // Also the case when a confirmed message was acked.
-
-  TX_WITH_RX = 2, // A downlink message was received after the transmission.
-                 // This also implies that a confirmed message is acked.
-
-  RADIO_LISTEN_WITHOUT_RX = 3 // listened to radio 2 radio but nothing came back
-};
-
-class rn2xx3
-{
-public:
-  /*
-     * A simplified constructor taking only a Stream ({Software/Hardware}Serial) object.
-     * The serial port should already be initialised when initialising this library.
-     */
-  rn2xx3(Stream &serial);
-
-  /*
-     * Transmit the correct sequence to the rn2xx3 to trigger its autobauding feature.
-     * After this operation the rn2xx3 should communicate at the same baud rate than us.
-     */
-  void autobaud();
-
-  /*
-     * Get the hardware EUI of the radio, so that we can register it on The Things Network
-     * and obtain the correct AppKey.
-     * You have to have a working serial connection to the radio before calling this function.
-     * In other words you have to at least call autobaud() some time before this function.
-     */
-  String hweui();
-
-  /*
-     * Returns the AppSKey or AppKey used when initializing the radio.
-     * In the case of ABP this function will return the App Session Key.
-     * In the case of OTAA this function will return the App Key.
-     */
-  String appkey();
-
-  /*
-     * In the case of OTAA this function will return the Application EUI used
-     * to initialize the radio.
-     */
-  String appeui();
-
-  /*
-     * In the case of OTAA this function will return the Device EUI used to
-     * initialize the radio. This is not necessarily the same as the Hardware EUI.
-     * To obtain the Hardware EUI, use the hweui() function.
-     */
-  String deveui();
-
-  /*
-     * Get the RN2xx3's hardware and firmware version number. This is also used
-     * to detect if the module is either an RN2483 or an RN2903.
-     */
-  String sysver();
-
-  /*
-     * Initialise the RN2xx3 and join the LoRa network (if applicable).
-     * This function can only be called after calling initABP() or initOTAA().
-     * The sole purpose of this function is to re-initialise the radio if it
-     * is in an unknown state.
-     */
-  bool init();
-
-  /*
-  * Initialise the RN2xx3 for P2P communication.
-  */
-  bool initP2P();
-
-  TX_RETURN_TYPE listenP2P();
-
-  /*
-     * Initialise the RN2xx3 and join a network using personalization.
-     *
-     * addr: The device address as a HEX string.
-     *       Example "0203FFEE"
-     * AppSKey: Application Session Key as a HEX string.
-     *          Example "8D7FFEF938589D95AAD928C2E2E7E48F"
-     * NwkSKey: Network Session Key as a HEX string.
-     *          Example "AE17E567AECC8787F749A62F5541D522"
-     */
-  bool initABP(const String &addr, const String &AppSKey, const String &NwkSKey);
-
-  //TODO: initABP(uint8_t * addr, uint8_t * AppSKey, uint8_t * NwkSKey)
-
-  /*
-     * Initialise the RN2xx3 and join a network using over the air activation.
-     *
-     * AppEUI: Application EUI as a HEX string.
-     *         Example "70B3D57ED00001A6"
-     * AppKey: Application key as a HEX string.
-     *         Example "A23C96EE13804963F8C2BD6285448198"
-     * DevEUI: Device EUI as a HEX string.
-     *         Example "0011223344556677"
-     * If the DevEUI parameter is omitted, the Hardware EUI from module will be used
-     * If no keys, or invalid length keys, are provided, no keys
-     * will be configured. If the module is already configured with some keys
-     * they will be used. Otherwise the join will fail and this function
-     * will return false.
-     */
-  bool initOTAA(const String &AppEUI = "", const String &AppKey = "", const String &DevEUI = "");
-
-  /*
-     * Initialise the RN2xx3 and join a network using over the air activation,
-     * using byte arrays. This is useful when storing the keys in eeprom or flash
-     * and reading them out in runtime.
-     *
-     * AppEUI: Application EUI as a uint8_t buffer
-     * AppKey: Application key as a uint8_t buffer
-     * DevEui: Device EUI as a uint8_t buffer (optional - set to 0 to use Hardware EUI)
-     */
-  bool initOTAA(uint8_t *AppEUI, uint8_t *AppKey, uint8_t *DevEui);
-
-  /*
-     * Transmit the provided data. The data is hex-encoded by this library,
-     * so plain text can be provided.
-     * This function is an alias for txUncnf().
-     *
-     * Parameter is an ascii text string.
-     */
-  TX_RETURN_TYPE tx(const String &data);
-
-  /*
-     * Transmit raw byte encoded data via LoRa WAN.
-     * This method expects a raw byte array as first parameter.
-     * The second parameter is the count of the bytes to send.
-     */
-  TX_RETURN_TYPE txBytes(const byte *data, uint8_t nbBytes);
-
-  /*
-     * Do a confirmed transmission via LoRa WAN.
-     *
-     * Parameter is an ascii text string.
-     */
-  TX_RETURN_TYPE txCnf(const String &data);
-
-  /*
-     * Do an unconfirmed transmission via LoRa WAN.
-     *
-     * Parameter is an ascii text string.
-     */
-  TX_RETURN_TYPE txUncnf(const String &data);
-
-  /*
-     * Change the datarate at which the RN2xx3 transmits.
-     * A value of between 0 and 5 can be specified,
-     * as is defined in the LoRaWan specs.
-     * This can be overwritten by the network when using OTAA.
-     * So to force a datarate, call this function after initOTAA().
-     */
-  void setDR(int dr);
-
-  /*
-     * Put the RN2xx3 to sleep for a specified timeframe.
-     * The RN2xx3 accepts values from 100 to 4294967296.
-     * Rumour has it that you need to do a autobaud() after the module wakes up again.
-     */
-  void sleep(long msec);
-
-  /*
-     * Send a raw command to the RN2xx3 module.
-     * Returns the raw string as received back from the RN2xx3.
-     * If the RN2xx3 replies with multiple line, only the first line will be returned.
-     */
-  String sendRawCommand(const String &command);
-
-  /*
-     * Returns the module type either RN2903 or RN2483, or NA.
-     */
-  RN2xx3_t moduleType();
-
-  /*
-     * Set the active channels to use.
-     * Returns true if setting the channels is possible.
-     * Returns false if you are trying to use the wrong channels on the wrong module type.
-     */
-  bool setFrequencyPlan(FREQ_PLAN);
-
-  /*
-     * Returns the last downlink message HEX string.
-     */
-  String getRx();
-
-  /*
-     * Get the RN2xx3's SNR of the last received packet. Helpful to debug link quality.
-     */
-  int getSNR();
-
-  /*
-     * Get the RN2xx3's voltage measurement on the Vdd in mVolt
-     * 0–3600 (decimal value from 0 to 3600)
-     */
-  int getVbat();
-
-  /*
-     * Encode an ASCII string to a HEX string as needed when passed
-     * to the RN2xx3 module.
-     */
-  String base16encode(const String &);
-
-  /*
-     * Decode a HEX string to an ASCII string. Useful to decode a
-     * string received from the RN2xx3.
-     */
-  String base16decode(const String &);
-
-  /*
-     * Almost all commands can return "invalid_param"
-     * The last command resulting in such an error can be retrieved.
-     * Reading this will clear the error.
-     */
-  String getLastErrorInvalidParam();
-
-private:
-  Stream &_serial;
-
-  RN2xx3_t _moduleType = RN_NA;
-
-  //Flags to switch code paths. Default is to use OTAA.
-  bool _otaa = true;
-
-  //The default address to use on TTN if no address is defined.
-  //This one falls in the "testing" address space.
-  String _devAddr = "03FFBEEF";
-
-  // if you want to use another DevEUI than the hardware one
-  // use this deveui for LoRa WAN
-  String _deveui = "0011223344556677";
-
-  //the appeui to use for LoRa WAN
-  String _appeui = "0";
-
-  //the nwkskey to use for LoRa WAN
-  String _nwkskey = "0";
-
-  //the appskey/appkey to use for LoRa WAN
-  String _appskey = "0";
-
-  // The downlink messenge
-  String _rxMessenge = "";
-
-  String _lastErrorInvalidParam = "";
-
-  bool _radio2radio = false;
-
-  /*
-     * Auto configure for either RN2903 or RN2483 module
-     */
-  RN2xx3_t configureModuleType();
-
-  void sendEncoded(const String &);
-
-  enum received_t
-  {
-    busy,
-    frame_counter_err_rejoin_needed,
-    invalid_data_len,
-    invalid_param,
-    mac_err,
-    mac_paused,
-    mac_rx,
-    mac_tx_ok,
-    no_free_ch,
-    not_joined,
-    ok,
-    radio_err,
-    radio_tx_ok,
-    radio_rx,
-    silent,
-    UNKNOWN
-  };
-
-  static received_t determineReceivedDataType(const String &receivedData);
-
-  int readIntValue(const String &command);
-
-  // All "mac set ..." commands return either "ok" or "invalid_param"
-  bool sendMacSet(const String &param, const String &value);
-  bool sendMacSetEnabled(const String &param, bool enabled);
-  bool sendMacSetCh(const String &param, unsigned int channel, const String &value);
-  bool sendMacSetCh(const String &param, unsigned int channel, uint32_t value);
-  bool setChannelDutyCycle(unsigned int channel, unsigned int dutyCycle);
-  bool setChannelFrequency(unsigned int channel, uint32_t frequency);
-  bool setChannelDataRateRange(unsigned int channel, unsigned int minRange, unsigned int maxRange);
-
-  // Set channel enabled/disabled.
-  // Frequency, data range, duty cycle must be issued prior to enabling the status of that channel
-  bool setChannelEnabled(unsigned int channel, bool enabled);
-
-  bool set2ndRecvWindow(unsigned int dataRate, uint32_t frequency);
-  bool setAdaptiveDataRate(bool enabled);
-  bool setAutomaticReply(bool enabled);
-  bool setTXoutputPower(int pwridx);
-
-  /*
-     * Transmit the provided data using the provided command.
-     *
-     * String - the tx command to send
-                can only be one of "mac tx cnf 1 " or "mac tx uncnf 1 "
-     * String - an ascii text string if bool is true. A HEX string if bool is false.
-     * bool - should the data string be hex encoded or not
-     */
-  TX_RETURN_TYPE txCommand(const String &command, const String &data, bool shouldEncode);
-};
-
-#endif
+/*
+ * A library for controlling a Microchip RN2xx3 LoRa radio.
+ *
+ * @Author JP Meijers
+ * @Author Nicolas Schteinschraber
+ * @Date 18/12/2015
+ *
+ */
+
+#ifndef rn2xx3_h
+#define rn2xx3_h
+
+#include "Arduino.h"
+#include "rn2xx3_airtime.h"
+#include "rn2xx3_command.h"
+#include "rn2xx3_datarate.h"
+#include "rn2xx3_line.h"
+#include "rn2xx3_log.h"
+#include "rn2xx3_queue.h"
+#include "rn2xx3_frames.h"
+#include "rn2xx3_reply.h"
+#include "rn2xx3_stats.h"
+
+/*
+ * The size macros here and in the headers above change the layout of
+ * rn2xx3, which is compiled on its own in rn2xx3.cpp. Set them for the
+ * whole build, for example with -DRN2XX3_QUEUE_BYTES=0, not with a
+ * #define before including rn2xx3.h: the sketch would then see another
+ * class than the library. Such a build fails to link, see rn2xx3_layout.
+ */
+
+/*
+ * Number of bytes of unanswered commands that may be written to the RN2xx3
+ * during a batch, see beginBatch(). Keep this below the size of the
+ * receive buffer of the RN2xx3.
+ */
+#ifndef RN2XX3_PIPELINE_BYTES
+#define RN2XX3_PIPELINE_BYTES 64
+#endif
+
+// The baud rate of the RN2xx3 after power up or a reset
+#define RN2XX3_DEFAULT_BAUD 57600
+
+// Maximum number of unanswered commands during a batch
+#ifndef RN2XX3_PIPELINE_DEPTH
+#define RN2XX3_PIPELINE_DEPTH 8
+#endif
+
+// Number of batch entries for which a failure can be looked up
+#ifndef RN2XX3_BATCH_MAX_ENTRIES
+#define RN2XX3_BATCH_MAX_ENTRIES 80
+#endif
+
+/*
+ * Number of channels for which the frequency, data rate range and duty
+ * cycle are remembered to skip redundant "mac set ch" commands (max 16).
+ */
+#ifndef RN2XX3_SHADOW_CHANNELS
+#if defined(__AVR__)
+#define RN2XX3_SHADOW_CHANNELS 8
+#else
+#define RN2XX3_SHADOW_CHANNELS 16
+#endif
+#endif
+
+// Number of ports that can have their own downlink handler
+#ifndef RN2XX3_DOWNLINK_HANDLERS
+#if defined(__AVR__)
+#define RN2XX3_DOWNLINK_HANDLERS 4
+#else
+#define RN2XX3_DOWNLINK_HANDLERS 8
+#endif
+#endif
+
+// Highest number of channels of the supported modules (RN2903)
+#define RN2XX3_MAX_CHANNELS 72
+
+// Bits of the reply to "mac get status"
+#define RN2XX3_MAC_STATUS_JOINED 0x0001UL
+#define RN2XX3_MAC_STATUS_SILENT 0x0040UL
+#define RN2XX3_MAC_STATUS_PAUSED 0x0080UL
+#define RN2XX3_MAC_STATUS_REJOIN_NEEDED 0x10000UL
+
+enum RN2xx3_t
+{
+  RN_NA = 0, // Not set
+  RN2903 = 2903,
+  RN2483 = 2483
+};
+
+enum FREQ_PLAN
+{
+  SINGLE_CHANNEL_EU,
+  TTN_EU,
+  TTN_US,
+  DEFAULT_EU
+};
+
+enum TX_RETURN_TYPE
+{
+  TX_FAIL = 0, // The transmission failed.
+               // If you sent a confirmed message and it is not acked,
+               // this will be the returned value.
+
+  TX_SUCCESS = 1, // The transmission was successful.
+                  // Also the case when a confirmed message was acked.
+
+  TX_WITH_RX = 2, // A downlink message was received after the transmission.
+                 // This also implies that a confirmed message is acked.
+
+  RADIO_LISTEN_WITHOUT_RX = 3 // listened to radio 2 radio but nothing came back
+};
+
+enum UPLINK_PRIORITY
+{
+  UPLINK_URGENT = 0, // Sent right away, ahead of the others
+  UPLINK_NORMAL = 1,
+  UPLINK_BULK = 2 // Only sent in frames with room to spare
+};
+
+/*
+ * Called when an uplink started with beginTx() or any of the blocking
+ * tx functions has completed.
+ */
+typedef void (*rn2xx3_tx_callback_t)(TX_RETURN_TYPE result);
+
+/*
+ * Called with every line the RN2xx3 sent on its own, outside of a reply to
+ * a command, like a late "mac_rx" or the "ok" after waking up.
+ * The line is only valid during the call.
+ */
+typedef void (*rn2xx3_unsolicited_callback_t)(const char *line);
+
+/*
+ * Called with a LoRaWAN downlink, see onDownlink().
+ * The payload is only valid during the call.
+ */
+typedef void (*rn2xx3_downlink_handler_t)(uint8_t port, const uint8_t *payload, uint16_t length);
+
+/*
+ * Called with a P2P frame, see startListenP2P().
+ * The payload is only valid during the call.
+ */
+typedef void (*rn2xx3_p2p_callback_t)(const uint8_t *payload, uint16_t length);
+
+/*
+ * Switches the serial port of the board to a baud rate, see setBaudRate().
+ */
+typedef void (*rn2xx3_baud_callback_t)(unsigned long baud);
+
+/*
+ * Settings of the radio for P2P communication. A new profile holds the
+ * settings initP2P() has always used; change the fields that should differ:
+ *
+ *   rn2xx3_radio_profile longRange;
+ *   longRange.sf = 12;
+ */
+struct rn2xx3_radio_profile
+{
+  bool fsk;           // modulation, false for LoRa
+  uint32_t frequency; // in Hz
+  int8_t power;       // in dBm
+  uint8_t sf;         // spreading factor, 7 to 12
+  uint16_t bw;        // bandwidth in kHz: 125, 250 or 500
+  uint8_t cr;         // coding rate 4/(4 + cr), so 1 for 4/5 up to 4 for 4/8
+  uint8_t sync;       // LoRa sync word
+  uint16_t preamble;  // in symbols
+  bool crc;
+  bool iqInvert;
+
+  rn2xx3_radio_profile()
+      : fsk(false), frequency(869100000UL), power(14), sf(7), bw(125), cr(1), sync(0x12), preamble(8),
+        crc(true), iqInvert(false)
+  {
+  }
+};
+
+/*
+ * rn2xx3.cpp defines the tag of the size of rn2xx3 it was compiled with.
+ * Every constructor call refers to the tag of the size its caller sees,
+ * so a sketch built with other size macros than the library fails to
+ * link, with an undefined rn2xx3_layout<size>::tag.
+ */
+template <size_t Size>
+struct rn2xx3_layout
+{
+  static const char tag;
+};
+
+/*
+ * The driver, for a serial port of type Transport. That is a Stream, or
+ * a serial port class with the same available(), read(), write(),
+ * print() and println(). The reads and writes of a class that is final,
+ * or whose members are not virtual, are direct calls the compiler can
+ * inline, which mostly helps receiving long downlinks, as every byte is
+ * read on its own:
+ *
+ *   rn2xx3_t<MyUart> myLora(uart);
+ *
+ * The members are all in this header. rn2xx3 is the driver for any
+ * Stream; it is compiled once, in rn2xx3.cpp.
+ */
+template <class Transport>
+class rn2xx3_t
+{
+public:
+  /*
+     * A simplified constructor taking only a serial port ({Software/Hardware}Serial) object.
+     * The serial port should already be initialised when initialising this library.
+     * Leave layout out, it is the check of rn2xx3_layout.
+     */
+  rn2xx3_t(Transport &serial, const char *layout = &rn2xx3_layout<sizeof(rn2xx3_t)>::tag);
+
+  /*
+     * Transmit the correct sequence to the rn2xx3 to trigger its autobauding feature.
+     * After this operation the rn2xx3 should communicate at the same baud rate than us.
+     * The sequence is repeated, waiting a little longer each time, until
+     * the RN2xx3 answers or timeoutMs has passed.
+     * Returns true if the RN2xx3 answered.
+     */
+  bool autobaud(unsigned long timeoutMs = 10000);
+
+  /*
+     * Returns how long the last autobaud() took, in milliseconds.
+     */
+  unsigned long getLastAutobaudTime();
+
+  /*
+     * Move the link to another baud rate, for example 115200 to spend less
+     * time on the wire with long command sequences and payloads.
+     * callback reconfigures the serial port of the board, for example
+     * with Serial1.begin(baud), and the RN2xx3 follows through autobaud.
+     * If the RN2xx3 does not answer, the previous baud rate is restored
+     * and false is returned. A module reset returns the RN2xx3 to 57600
+     * baud, so the library autobauds again after the reset of initP2P().
+     */
+  bool setBaudRate(unsigned long baud, rn2xx3_baud_callback_t callback);
+
+  /*
+     * Get the hardware EUI of the radio, so that we can register it on The Things Network
+     * and obtain the correct AppKey.
+     * You have to have a working serial connection to the radio before calling this function.
+     * In other words you have to at least call autobaud() some time before this function.
+     */
+  String hweui();
+
+  /*
+     * Returns the AppSKey or AppKey used when initializing the radio.
+     * In the case of ABP this function will return the App Session Key.
+     * In the case of OTAA this function will return the App Key.
+     */
+  String appkey();
+
+  /*
+     * In the case of OTAA this function will return the Application EUI used
+     * to initialize the radio.
+     */
+  String appeui();
+
+  /*
+     * In the case of OTAA this function will return the Device EUI used to
+     * initialize the radio. This is not necessarily the same as the Hardware EUI.
+     * To obtain the Hardware EUI, use the hweui() function.
+     */
+  String deveui();
+
+  /*
+     * Get the RN2xx3's hardware and firmware version number. This is also used
+     * to detect if the module is either an RN2483 or an RN2903.
+     */
+  String sysver();
+
+  /*
+     * Initialise the RN2xx3 and join the LoRa network (if applicable).
+     * This function can only be called after calling initABP() or initOTAA().
+     * The sole purpose of this function is to re-initialise the radio if it
+     * is in an unknown state.
+     */
+  bool init();
+
+  /*
+     * Continue with the LoRaWAN session the RN2xx3 already has, without
+     * a reset or a new join. A paused MAC is resumed.
+     * Returns false if the RN2xx3 is not joined, in which case one of the
+     * init functions has to be called.
+     */
+  bool resume();
+
+  /*
+     * By default initOTAA() and initABP() first try to continue the session
+     * the RN2xx3 already has for the same device, which takes well below a
+     * second instead of a reset and join. For ABP a session saved with
+     * "mac save" is also used after the RN2xx3 itself restarted, with the
+     * frame counters of the last save.
+     * Disable this to always start with a reset of the MAC.
+     */
+  void setSessionResume(bool enabled);
+
+  /*
+     * Get the uplink and downlink frame counters of the current session.
+     */
+  uint32_t getFrameCounterUp();
+  uint32_t getFrameCounterDown();
+
+  /*
+  * Initialise the RN2xx3 for P2P communication, with the settings of
+  * profile or else those of a default rn2xx3_radio_profile.
+  */
+  bool initP2P();
+  bool initP2P(const rn2xx3_radio_profile &profile);
+
+  /*
+  * Change the P2P settings after initP2P(). Only the settings that differ
+  * from the profile applied last are sent to the RN2xx3.
+  * Returns false if the RN2xx3 rejected one of them.
+  */
+  bool setRadioProfile(const rn2xx3_radio_profile &profile);
+
+  /*
+  * Wait for one P2P frame, until the watchdog of the RN2xx3 ends the wait.
+  * Returns TX_WITH_RX with the frame available through getRx(), or
+  * RADIO_LISTEN_WITHOUT_RX.
+  */
+  TX_RETURN_TYPE listenP2P();
+
+  /*
+  * Listen for P2P frames in the background, after initP2P().
+  * poll() passes every frame to callback, and switches the receiver on
+  * again after each frame and each watchdog timeout of the RN2xx3.
+  * Commands and transmissions pause listening, the next poll() resumes it.
+  * Pausing waits for a reply still on its way, see beginTx().
+  * Returns false when the RN2xx3 is not set up for P2P.
+  */
+  bool startListenP2P(rn2xx3_p2p_callback_t callback = NULL);
+  void stopListenP2P();
+  bool listeningP2P();
+
+  /*
+  * Frames received while listening are also kept in a ring (see
+  * rn2xx3_frames.h), with the time they arrived and their SNR, which is
+  * asked right after each frame. Take up to max of the oldest frames,
+  * copied back to back into buffer with their lengths in info.
+  * Returns the number of frames taken. With RN2XX3_FRAME_RING_BYTES set
+  * to 0 there is no ring, and frames only reach the callback.
+  */
+  uint8_t readFramesP2P(uint8_t *buffer, uint16_t size, rn2xx3_frame_info *info, uint8_t max);
+  uint8_t getAvailableFramesP2P();
+
+  /*
+  * Frames lost because the ring was full, or because they were too long
+  * for the ring or the line buffer.
+  */
+  unsigned long getDroppedFramesP2P();
+  unsigned long getOverflowedFramesP2P();
+
+  /*
+     * Initialise the RN2xx3 and join a network using personalization.
+     *
+     * addr: The device address as a HEX string.
+     *       Example "0203FFEE"
+     * AppSKey: Application Session Key as a HEX string.
+     *          Example "8D7FFEF938589D95AAD928C2E2E7E48F"
+     * NwkSKey: Network Session Key as a HEX string.
+     *          Example "AE17E567AECC8787F749A62F5541D522"
+     */
+  bool initABP(const String &addr, const String &AppSKey, const String &NwkSKey);
+
+  //TODO: initABP(uint8_t * addr, uint8_t * AppSKey, uint8_t * NwkSKey)
+
+  /*
+     * Initialise the RN2xx3 and join a network using over the air activation.
+     *
+     * AppEUI: Application EUI as a HEX string.
+     *         Example "70B3D57ED00001A6"
+     * AppKey: Application key as a HEX string.
+     *         Example "A23C96EE13804963F8C2BD6285448198"
+     * DevEUI: Device EUI as a HEX string.
+     *         Example "0011223344556677"
+     * If the DevEUI parameter is omitted, the Hardware EUI from module will be used
+     * If no keys, or invalid length keys, are provided, no keys
+     * will be configured. If the module is already configured with some keys
+     * they will be used. Otherwise the join will fail and this function
+     * will return false.
+     */
+  bool initOTAA(const String &AppEUI = "", const String &AppKey = "", const String &DevEUI = "");
+
+  /*
+     * Initialise the RN2xx3 and join a network using over the air activation,
+     * using byte arrays. This is useful when storing the keys in eeprom or flash
+     * and reading them out in runtime.
+     *
+     * AppEUI: Application EUI as a uint8_t buffer
+     * AppKey: Application key as a uint8_t buffer
+     * DevEui: Device EUI as a uint8_t buffer (optional - set to 0 to use Hardware EUI)
+     */
+  bool initOTAA(uint8_t *AppEUI, uint8_t *AppKey, uint8_t *DevEui);
+
+  /*
+     * Transmit the provided data. The data is hex-encoded by this library,
+     * so plain text can be provided.
+     * This function is an alias for txUncnf().
+     *
+     * Parameter is an ascii text string.
+     */
+  TX_RETURN_TYPE tx(const String &data);
+
+  /*
+     * Transmit raw byte encoded data via LoRa WAN.
+     * This method expects a raw byte array as first parameter.
+     * The second parameter is the count of the bytes to send.
+     */
+  TX_RETURN_TYPE txBytes(const byte *data, uint8_t nbBytes);
+
+  /*
+     * Do a confirmed transmission via LoRa WAN.
+     *
+     * Parameter is an ascii text string.
+     */
+  TX_RETURN_TYPE txCnf(const String &data);
+
+  /*
+     * Do an unconfirmed transmission via LoRa WAN.
+     *
+     * Parameter is an ascii text string.
+     */
+  TX_RETURN_TYPE txUncnf(const String &data);
+
+  /*
+     * Start a transmission without waiting for its result.
+     * The data is hex-encoded by this library, so plain text can be provided.
+     * Returns false if another transmission is still in progress.
+     *
+     * Call poll() regularly until txPending() returns false, then read the
+     * outcome using txResult(), or register a callback with onTxDone().
+     * Do not send other commands to the RN2xx3 while a transmission is pending.
+     *
+     * Only starting the transmission waits for the RN2xx3, as a command
+     * does, before the first attempt is written:
+     * - a sleeping RN2xx3 is woken, see wake(): up to 100 ms for its
+     *   "ok", up to 200 ms for "sys get vdd" and, if that fails,
+     *   autobaud();
+     * - the replies of a batch still in flight are collected, and a
+     *   line half way through arriving gets up to 50 ms;
+     * - background listening is paused: up to 2 s for the reply to
+     *   "radio rx" or "radio get snr", then "radio rxstop";
+     * - for LoRaWAN, "mac get dr" when the data rate is not cached, and
+     *   with data rate control the reads of updateDataRate() and the
+     *   "mac set dr" of a new data rate.
+     * An awake RN2xx3 that is not listening, with the data rate cached,
+     * is not waited for.
+     */
+  bool beginTx(const String &data, bool confirmed = false);
+
+  /*
+     * Start a transmission of raw bytes without waiting for its result.
+     * See beginTx() for how to follow up on the transmission.
+     * The bytes are not copied: data must stay valid until txPending()
+     * returns false, as it is read again on every retry.
+     */
+  bool beginTxBytes(const byte *data, uint8_t size, bool confirmed = false);
+
+  /*
+     * Move a pending transmission forward. Only the bytes already received
+     * from the RN2xx3 are read, so while a transmission is pending this
+     * function never waits for the radio.
+     * Retries on "busy" or "no_free_ch" are scheduled, not slept.
+     * Replies that need a new join end the transmission with TX_FAIL,
+     * see rejoinNeeded().
+     * When nothing is pending, poll() starts the frame of the uplink queue
+     * that is due, if any; starting it waits as beginTx() describes.
+     * Returns true while a transmission is still in progress.
+     */
+  bool poll();
+
+  /*
+     * Returns true once a reply to an uplink, like "not_joined" or
+     * "mac_err", showed that the RN2xx3 has to be initialised again.
+     * poll() leaves that to rejoin(), as a join can take a minute. The
+     * blocking tx functions call rejoin() themselves and send again,
+     * and poll() sends no queued uplinks until it is done.
+     */
+  bool rejoinNeeded();
+
+  /*
+     * Initialise the RN2xx3 again as rejoinNeeded() asks for. Waits for
+     * the join. Returns true if the RN2xx3 is ready again or nothing
+     * had to be done.
+     */
+  bool rejoin();
+
+  /*
+     * Returns true while a transmission started by beginTx() has not completed.
+     */
+  bool txPending();
+
+  /*
+     * Returns the outcome of the last completed transmission.
+     */
+  TX_RETURN_TYPE txResult();
+
+  /*
+     * Register a function to be called whenever a transmission completes.
+     * Pass NULL to remove the callback.
+     */
+  void onTxDone(rn2xx3_tx_callback_t callback);
+
+  /*
+     * Queue a message for an uplink on port 1, to be sent by poll().
+     * poll() sends a frame once a message is urgent, a message has waited
+     * maxDelayMs or the queue fills a frame, and the duty cycle allows it.
+     * It then packs as many queued messages as the current data rate
+     * allows into one frame, each preceded by its length (see
+     * rn2xx3_queue.h). As poll() does not ask the RN2xx3, frames are
+     * sized for the slowest data rate when the data rate is unknown, as
+     * after a raw command or an ADR change. Messages that do not fit then
+     * wait until sendQueuedUplinks() or another transmission has read the
+     * data rate; only messages too large for the known data rate are
+     * dropped. Returns false if the queue has no room, always when
+     * RN2XX3_QUEUE_BYTES is set to 0.
+     */
+  bool queueUplink(const byte *data, uint8_t size, UPLINK_PRIORITY priority = UPLINK_NORMAL, unsigned long maxDelayMs = 60000);
+
+  /*
+     * Start a frame with the queued messages now, without waiting for
+     * more. Reads the data rate from the RN2xx3 first when it is unknown,
+     * and waits to start the frame as beginTx() describes.
+     * Returns false if nothing was started.
+     */
+  bool sendQueuedUplinks();
+
+  /*
+     * Returns the number of queued messages, including those being sent.
+     */
+  uint8_t getQueuedUplinks();
+
+  /*
+     * Returns the number of queued messages given up on: their frame
+     * failed, or they were too large for the data rate.
+     */
+  unsigned long getDroppedUplinks();
+
+  /*
+     * Change the datarate at which the RN2xx3 transmits.
+     * A value of between 0 and 5 can be specified,
+     * as is defined in the LoRaWan specs.
+     * This can be overwritten by the network when using OTAA.
+     * So to force a datarate, call this function after initOTAA().
+     */
+  void setDR(int dr);
+
+  /*
+     * Let the library choose the data rate, instead of the network with
+     * adaptive data rate. After each uplink it measures the link: the SNR
+     * of a downlink, and every linkCheckS seconds a LoRaWAN link check
+     * for the margin and the number of gateways. Before the next uplink
+     * it sets the fastest data rate from minDr to maxDr that keeps
+     * targetMargin dB above what the gateways can still receive.
+     * A link check that no gateway answered steps one data rate down.
+     * The data rate is set when the application starts an uplink or
+     * calls sendQueuedUplinks(); frames poll() sends on its own keep it.
+     * Pass linkCheckS 0 to only use downlinks. The setting is kept when
+     * the radio is initialised, and turns adaptive data rate off.
+     * Call it after initOTAA() or initABP(), so the band is known.
+     * Returns false when the RN2xx3 refused the settings.
+     */
+  bool enableDataRateControl(uint8_t targetMargin = 5, uint16_t linkCheckS = 600, uint8_t minDr = 0, uint8_t maxDr = 5);
+  void disableDataRateControl();
+
+  /*
+     * Put the RN2xx3 to sleep for a specified timeframe.
+     * The RN2xx3 accepts values from 100 to 4294967296.
+     * Listening with startListenP2P() stops. The library remembers when
+     * the module wakes up; the next command or transmission calls wake()
+     * first, which waits for the RN2xx3.
+     */
+  void sleep(long msec);
+
+  /*
+     * Make sure the RN2xx3 is awake and answers. Before the end of its
+     * sleep it is woken with a break. One short command then checks the
+     * link, and only when that fails a full autobaud() follows.
+     * Returns true once the RN2xx3 answers.
+     */
+  bool wake();
+
+  // True from sleep() until wake()
+  bool sleeping();
+
+  /*
+     * Returns how long the last wake() took until the RN2xx3 answered,
+     * in microseconds.
+     */
+  unsigned long getLastWakeLatency();
+
+  /*
+     * Send a raw command to the RN2xx3 module.
+     * Returns the raw string as received back from the RN2xx3.
+     * If the RN2xx3 replies with multiple line, only the first line will be returned.
+     */
+  String sendRawCommand(const String &command);
+
+  /*
+     * Start a batch of configuration commands.
+     * Until the matching endBatch(), commands that only reply "ok" or an error
+     * are written to the RN2xx3 without waiting for their reply, as fast as
+     * its receive buffer allows. The replies are matched to the commands in
+     * order. setFrequencyPlan(), initP2P() and the init functions use a batch
+     * internally. Batches can be nested, the outermost one collects the results.
+     */
+  void beginBatch();
+
+  /*
+     * Wait for the replies to all commands in the batch.
+     * Returns the number of commands that did not reply "ok".
+     */
+  uint8_t endBatch();
+
+  /*
+     * Send a list of commands as one batch, e.g. "mac set ch status 8 on".
+     * Returns the number of commands that did not reply "ok".
+     */
+  uint8_t sendBatch(const String commands[], uint8_t count);
+
+  /*
+     * Returns true if the command at index (counting from 0) of the last
+     * batch did not reply "ok".
+     */
+  bool batchEntryFailed(uint8_t index);
+
+  /*
+     * Returns the number of failed commands in the last batch.
+     */
+  uint8_t getBatchFailures();
+
+  /*
+     * Returns the time in microseconds between writing the last command
+     * and receiving its reply.
+     */
+  unsigned long getLastCommandRoundTrip();
+
+  /*
+     * Register a function to be called with lines the RN2xx3 sent on its own.
+     * Downlinks among them are also available through getRx().
+     * Pass NULL to remove the callback.
+     */
+  void onUnsolicited(rn2xx3_unsolicited_callback_t callback);
+
+  /*
+     * Register a function to be called with every downlink on port, or
+     * with port 0 for the downlinks on ports without a handler of their own.
+     * Handlers run from the tx functions and poll(). To answer, queue an
+     * uplink with queueUplink(). Pass NULL to remove a handler.
+     * Returns false when all RN2XX3_DOWNLINK_HANDLERS are taken.
+     */
+  bool onDownlink(uint8_t port, rn2xx3_downlink_handler_t handler);
+
+  /*
+     * Let the RN2xx3 answer a confirmed downlink, or one that says more
+     * are waiting, with an empty uplink right away. The network can then
+     * send all its queued downlinks in one burst, and each is passed to
+     * the downlink handlers as it arrives.
+     * Off by default; the setting is kept when the radio is initialised.
+     */
+  bool setAutomaticReply(bool enabled);
+
+  /*
+     * Returns the module type either RN2903 or RN2483, or NA.
+     */
+  RN2xx3_t moduleType();
+
+  /*
+     * Set the active channels to use.
+     * Returns true if setting the channels is possible.
+     * Returns false if you are trying to use the wrong channels on the wrong module type.
+     */
+  bool setFrequencyPlan(FREQ_PLAN);
+
+  /*
+     * Time on air in microseconds of an uplink with payloadSize bytes at
+     * the current data rate.
+     */
+  uint32_t getTimeOnAir(uint8_t payloadSize);
+
+  /*
+     * The millis() value from which the duty cycle of the channels allows
+     * the next uplink, or millis() when one can be sent right away.
+     * Predicted from the uplinks sent so far and the duty cycle settings.
+     * When the RN2xx3 replies "no_free_ch" the library waits until this
+     * time before it retries, instead of asking again every second.
+     * Always millis() when RN2XX3_DUTY_CYCLE_CHANNELS is set to 0.
+     */
+  unsigned long nextTxAllowedAt();
+
+  /*
+     * Returns the last downlink message HEX string.
+     */
+  String getRx();
+
+  /*
+     * The FPort of the last downlink message, or 0 after a radio_rx.
+     */
+  uint8_t getRxPort();
+
+  /*
+     * The bytes of the last downlink message, valid until the next one.
+     * A downlink too long for RN2XX3_LINE_BUFFER_SIZE leaves none, and
+     * is not passed to the handlers of onDownlink().
+     */
+  const uint8_t *getRxBytes();
+  uint16_t getRxLength();
+
+  /*
+     * Get the RN2xx3's SNR of the last received packet. Helpful to debug link quality.
+     */
+  int getSNR();
+
+  /*
+     * Get the RN2xx3's voltage measurement on the Vdd in mVolt
+     * 0–3600 (decimal value from 0 to 3600)
+     */
+  int getVbat();
+
+  /*
+     * Encode an ASCII string to a HEX string as needed when passed
+     * to the RN2xx3 module.
+     */
+  String base16encode(const String &);
+
+  /*
+     * Decode a HEX string to an ASCII string. Useful to decode a
+     * string received from the RN2xx3.
+     * Returns an empty string when the input is not valid HEX.
+     * NUL characters are left out.
+     */
+  String base16decode(const String &);
+
+  /*
+     * The library remembers the MAC settings it made, and skips setting the
+     * same value again. These return how often a setting was skipped (hit)
+     * or had to be sent to the RN2xx3 (miss).
+     */
+  unsigned long getCacheHits();
+  unsigned long getCacheMisses();
+
+  /*
+     * Copy the counters and latency histograms gathered since the last
+     * reset into stats, for example to send in a periodic health uplink.
+     * With reset set they start from zero again. All zeros when
+     * RN2XX3_STATS is set to 0.
+     */
+  void getStats(rn2xx3_stats &stats, bool reset = false);
+  void resetStats();
+
+  /*
+     * Write up to max of the oldest log records to out, as lines of text.
+     * Returns the number written. Logging is compiled in by defining
+     * RN2XX3_LOG_LEVEL; events are then stored as small binary records in
+     * a ring of RN2XX3_LOG_ENTRIES, so they do not change the timing of the
+     * radio, and are only formatted here.
+     */
+  uint8_t flushLog(Print &out, uint8_t max = 255);
+
+  /*
+     * Let poll() flush one log record each time it finds the radio idle.
+     * Pass NULL to stop.
+     */
+  void setLogOutput(Print *out);
+
+  // Log records overwritten before they were flushed
+  unsigned long getLostLogRecords();
+
+  /*
+     * Forget the remembered MAC settings, so the next setters send their
+     * commands again. This is done automatically on a reset of the RN2xx3,
+     * and after raw commands, also in sendBatch(), that could change a
+     * setting.
+     */
+  void invalidateCache();
+
+  /*
+     * Almost all commands can return "invalid_param"
+     * The last command resulting in such an error can be retrieved.
+     * Reading this will clear the error.
+     */
+  String getLastErrorInvalidParam();
+
+private:
+  Transport &_serial;
+
+  RN2xx3_t _moduleType = RN_NA;
+
+  //Flags to switch code paths. Default is to use OTAA.
+  bool _otaa = true;
+
+  //The default address to use on TTN if no address is defined.
+  //This one falls in the "testing" address space.
+  String _devAddr = "03FFBEEF";
+
+  // if you want to use another DevEUI than the hardware one
+  // use this deveui for LoRa WAN
+  String _deveui = "0011223344556677";
+
+  //the appeui to use for LoRa WAN
+  String _appeui = "0";
+
+  //the nwkskey to use for LoRa WAN
+  String _nwkskey = "0";
+
+  //the appskey/appkey to use for LoRa WAN
+  String _appskey = "0";
+
+  // The last downlink message
+  uint8_t _rxBytes[RN2XX3_LINE_BUFFER_SIZE / 2];
+  uint16_t _rxLength = 0;
+  uint8_t _rxPort = 0;
+
+  uint8_t _downlinkPorts[RN2XX3_DOWNLINK_HANDLERS];
+  rn2xx3_downlink_handler_t _downlinkHandlers[RN2XX3_DOWNLINK_HANDLERS];
+
+  bool _automaticReply = false;
+
+  // Data rate control, see enableDataRateControl()
+  bool _dataRateControl = false;
+  uint16_t _linkCheckS = 0;
+  unsigned long _linkCheckDue = 0;
+  bool _txLinkCheck = false; // the uplink being sent asks for a link check
+  uint8_t _linkPending = 0;  // measurements to read after the last uplink
+  uint8_t _linkDataRate = 0; // the data rate of that uplink
+  rn2xx3_datarate _dataRate;
+
+  // Bits of _linkPending
+  enum
+  {
+    LINK_CHECK = 0x01,
+    LINK_SNR = 0x02
+  };
+
+  bool applyLinkCheck();
+
+  // Read the measurements of the last uplink and set the data rate
+  void updateDataRate();
+
+  // The data rate init sets, unless the network or the controller decides
+  uint8_t initialDataRate();
+
+  String _lastErrorInvalidParam = "";
+
+  bool _radio2radio = false;
+
+  bool _sessionResume = true;
+
+  // Hardware EUI, asked once
+  char _hweui[17];
+
+  // Shadow copy of the MAC settings of the RN2xx3. -1 means unknown.
+  struct shadow_t
+  {
+    int8_t dr;
+    int8_t pwridx;
+    int8_t adr;
+    int8_t ar;
+    int8_t rx2DataRate;
+    uint32_t rx2Frequency;
+    uint8_t statusKnown[(RN2XX3_MAX_CHANNELS + 7) / 8];
+    uint8_t statusOn[(RN2XX3_MAX_CHANNELS + 7) / 8];
+    uint16_t dcycleKnown;
+    uint16_t freqKnown;
+    uint16_t drrangeKnown;
+    uint16_t dcycle[RN2XX3_SHADOW_CHANNELS];
+    uint32_t freq[RN2XX3_SHADOW_CHANNELS];
+    uint8_t drrange[RN2XX3_SHADOW_CHANNELS]; // min << 4 | max
+  } _shadow;
+
+  // The P2P settings applied last, and which of them the RN2xx3 has
+  rn2xx3_radio_profile _radio;
+  uint16_t _radioKnown = 0;
+
+  // Bits of _radioKnown
+  enum
+  {
+    RADIO_KNOWN_MOD = 0x0001,
+    RADIO_KNOWN_FREQ = 0x0002,
+    RADIO_KNOWN_PWR = 0x0004,
+    RADIO_KNOWN_SF = 0x0008,
+    RADIO_KNOWN_BW = 0x0010,
+    RADIO_KNOWN_CR = 0x0020,
+    RADIO_KNOWN_SYNC = 0x0040,
+    RADIO_KNOWN_PRLEN = 0x0080,
+    RADIO_KNOWN_CRC = 0x0100,
+    RADIO_KNOWN_IQI = 0x0200
+  };
+
+  // Send the P2P settings that differ from _radio
+  void applyRadioProfile(const rn2xx3_radio_profile &profile);
+  bool radioCacheHit(uint16_t setting, bool matches);
+
+  unsigned long _cacheHits = 0;
+  unsigned long _cacheMisses = 0;
+
+  // Counts a hit or miss of the shadow copy and returns matches
+  bool cacheHit(bool matches);
+
+  // Forget what the network can change using MAC commands
+  void invalidateNetworkControlled(bool dataRate);
+
+  // State of the transmission engine driven by poll()
+  enum tx_state_t
+  {
+    TX_IDLE,
+    TX_RETRY,       // (re)send the command once _txDeadline has passed
+    TX_WAIT_REPLY,  // waiting for the direct reply to the tx command
+    TX_WAIT_RESULT, // waiting for the reply after the RX windows
+    TX_REJOIN       // a blocking tx waits for waitTx() to rejoin
+  };
+
+  // The re-initialisation a reply asked for, see rejoin()
+  enum rejoin_t
+  {
+    REJOIN_NONE,
+    REJOIN_INIT,  // init(), which may resume the session
+    REJOIN_FORCED // a new join
+  };
+
+  tx_state_t _txState = TX_IDLE;
+  bool _txBlocking = false; // started by txCommand(), which waits for it
+  rejoin_t _rejoin = REJOIN_NONE;
+  rn2xx3_command::id_t _txCommand = rn2xx3_command::MAC_TX_UNCNF;
+  // The payload is hex-encoded into the UART on every attempt, so it is
+  // never stored encoded. Only beginTx() keeps a copy, in _txText.
+  const uint8_t *_txData = NULL;
+  uint16_t _txLength = 0;
+  String _txText;
+  uint8_t _txRetryCount = 0;
+  uint8_t _txBusyCount = 0;
+  unsigned long _txDeadline = 0;
+  TX_RETURN_TYPE _txResult = TX_FAIL;
+  uint8_t _txDataRate = 0;
+  rn2xx3_tx_callback_t _txCallback = NULL;
+
+  // State of background P2P receive, see startListenP2P()
+  enum listen_state_t
+  {
+    LISTEN_OFF,
+    LISTEN_ARMING, // "radio rx" sent, waiting for its reply
+    LISTEN_ACTIVE, // receiving until a frame or the watchdog ends it
+    LISTEN_SNR,    // "radio get snr" sent after a frame, waiting for its reply
+    LISTEN_RESUME  // switch the receiver on once _listenDeadline has passed
+  };
+
+  listen_state_t _listenState = LISTEN_OFF;
+  bool _listenRearm = false;
+  bool _listenReceived = false;
+  unsigned long _listenDeadline = 0;
+  rn2xx3_p2p_callback_t _p2pCallback = NULL;
+#if RN2XX3_FRAME_RING_BYTES > 0
+  rn2xx3_frames _frames;
+#endif
+
+  void armListen();
+  void resumeListen(unsigned long waitMs);
+  void pauseListen();
+  void endListenWindow();
+
+  // Returns true if the line belonged to listening
+  bool handleListenLine(const rn2xx3_line &receivedData);
+
+#if RN2XX3_QUEUE_BYTES > 0
+  rn2xx3_queue _uplinks;
+  unsigned long _uplinksDropped = 0;
+#endif
+
+  // Start a frame from the uplink queue when it is due, or when forced
+  bool startQueuedUplink(bool force);
+
+  // Assembles the response lines, shared by all code paths
+  rn2xx3_line_reader _reader;
+
+#if RN2XX3_STATS
+  // See getStats(). Bytes read are counted by _reader.
+  rn2xx3_stats _stats;
+  unsigned long _statsBytesRead = 0; // _reader.bytesRead() at the last reset
+  unsigned long _txSentAt = 0;
+  unsigned long _txOkAt = 0;
+#endif
+
+  void countWrite(size_t bytes);
+
+#if RN2XX3_LOG_LEVEL > RN2XX3_LOG_NONE
+  rn2xx3_log _log;
+  Print *_logOutput = NULL;
+#endif
+
+  unsigned long _lastCommandRoundTrip = 0;
+
+  // The baud rate of the link, and how long syncing to it took last
+  unsigned long _baud = RN2XX3_DEFAULT_BAUD;
+  unsigned long _lastAutobaudTime = 0;
+
+  // See sleep() and wake()
+  bool _sleeping = false;
+  bool _wakeSeen = false; // the "ok" of the RN2xx3 waking up arrived
+  unsigned long _sleepUntil = 0;
+  unsigned long _lastWakeLatency = 0;
+
+  // Pipelined batch of commands, see beginBatch()
+  uint8_t _batchDepth = 0;
+  uint8_t _batchSize = 0;
+  uint8_t _batchFailures = 0;
+  uint8_t _batchFailed[(RN2XX3_BATCH_MAX_ENTRIES + 7) / 8];
+  bool _commandTooLong = false; // a command was refused since the init function started
+  uint8_t _pipeLengths[RN2XX3_PIPELINE_DEPTH];
+#if RN2XX3_STATS
+  unsigned long _pipeSentAt[RN2XX3_PIPELINE_DEPTH];
+#endif
+  uint8_t _pipeHead = 0;
+  uint8_t _pipeCount = 0;
+  uint16_t _pipeBytes = 0;
+  rn2xx3_unsolicited_callback_t _unsolicitedCallback = NULL;
+
+  /*
+     * Auto configure for either RN2903 or RN2483 module
+     */
+  RN2xx3_t configureModuleType();
+
+  uint32_t readMacStatus();
+
+  // The data rate from the cache, asking the RN2xx3 if it is unknown
+  uint8_t currentDataRate();
+
+  // The data rate without asking the RN2xx3: the last one known, or else the slowest
+  uint8_t knownDataRate();
+
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+  // Duty cycle of the channels, to predict when a channel is free
+  rn2xx3_dutycycle _dutyCycle;
+#endif
+
+  // Compare the HEX reply to a get command, ignoring case
+  bool sameHex(rn2xx3_command::id_t command, const String &expected);
+
+  bool resumeOTAA(const String &AppEUI, const String &DevEUI);
+  bool resumeABP(const String &devAddr);
+
+  /*
+     * Re-initialise without resuming the session, for errors that only a
+     * new join can solve.
+     */
+  bool forceInit();
+
+  typedef rn2xx3_reply::type_t received_t;
+
+  static received_t determineReceivedDataType(const rn2xx3_line &receivedData);
+
+  /*
+     * Returns true for the lines that end an uplink. They can arrive late,
+     * like after an automatic reply, and are never the reply to a command.
+     */
+  static bool isTxResult(received_t type);
+
+  // Count the errors of getStats()
+  void countReply(received_t type);
+
+  int readIntValue(rn2xx3_command::id_t command);
+
+  bool setChannelDutyCycle(unsigned int channel, unsigned int dutyCycle);
+  bool setChannelFrequency(unsigned int channel, uint32_t frequency);
+  bool setChannelDataRateRange(unsigned int channel, unsigned int minRange, unsigned int maxRange);
+
+  // Set channel enabled/disabled.
+  // Frequency, data range, duty cycle must be issued prior to enabling the status of that channel
+  bool setChannelEnabled(unsigned int channel, bool enabled);
+
+  bool set2ndRecvWindow(unsigned int dataRate, uint32_t frequency);
+  bool setAdaptiveDataRate(bool enabled);
+  bool setTXoutputPower(int pwridx);
+
+  /*
+     * Transmit the provided data using the provided command.
+     *
+     * command - the tx command to send
+                 can only be one of MAC_TX_CNF, MAC_TX_UNCNF or RADIO_TX
+     * data, length - the bytes to send, hex-encoded while they are written.
+                      They must stay valid until the transmission completes.
+     */
+  TX_RETURN_TYPE txCommand(rn2xx3_command::id_t command, const uint8_t *data, uint16_t length);
+
+  /*
+     * Read the link measurements and the data rate before an uplink the
+     * application starts. Waits for the RN2xx3, so poll() never calls it.
+     */
+  void prepareTx();
+
+  // Non-blocking building blocks of txCommand()
+  bool startTx(rn2xx3_command::id_t command, const uint8_t *data, uint16_t length);
+  TX_RETURN_TYPE waitTx();
+  void sendTxAttempt();
+  void retryTx(unsigned long waitMs);
+  void finishTx(TX_RETURN_TYPE result);
+  // Ask for a rejoin, which ends a non-blocking tx with TX_FAIL
+  void rejoinTx(rejoin_t rejoin);
+  void handleTxReply(const rn2xx3_line &receivedData);
+  void handleTxResult(const rn2xx3_line &receivedData);
+
+  /*
+     * Send a command and wait at most timeoutMs for its first reply line.
+     * The returned view is only valid until the next line is read.
+     */
+  rn2xx3_line sendCommand(rn2xx3_command::id_t command, unsigned long timeoutMs = 2000);
+  rn2xx3_line sendCommand(const rn2xx3_command &command, unsigned long timeoutMs = 2000);
+  rn2xx3_line sendCommand(const String &command, unsigned long timeoutMs = 2000);
+
+  // Forget the shadow copies and duty cycle ledger a raw command may change
+  void forgetRawCommand(const String &command);
+
+  // Write a command from program memory, or else the text, with line ending
+  rn2xx3_line sendLine(const __FlashStringHelper *command, const char *text, size_t length, unsigned long timeoutMs);
+  void writeLine(const __FlashStringHelper *command, const char *text, size_t length);
+
+  /*
+     * Send a command that replies "ok" on success.
+     * During a batch the command is pipelined and true is returned.
+     */
+  bool sendCommandOk(const rn2xx3_command &command);
+  bool sendCommandOk(const String &command);
+  bool pipelineCommand(const char *command, size_t length);
+  void collectBatchReply();
+  void collectBatchReplies();
+  void failBatchEntry();
+
+  // Fail a command whose arguments did not fit, instead of sending it
+  void refuseCommand();
+
+  /*
+     * Handle the lines that arrived since the last command, so they are not
+     * mistaken for the reply to the next one. Pauses P2P listening, as the
+     * RN2xx3 is about to get a command.
+     */
+  void drainUnsolicited();
+  void handleUnsolicited(const rn2xx3_line &receivedData);
+
+  /*
+     * Keep the payload of a downlink, a part of the current line, as the
+     * last received message. Returns false, leaving no message, when the
+     * line was too long for the line buffer.
+     */
+  bool storeRx(uint8_t port, const rn2xx3_line &payload);
+
+  // Pass the last received message to the handler of its port
+  void dispatchDownlink();
+};
+
+#include "rn2xx3_impl.h"
+
+typedef rn2xx3_t<Stream> rn2xx3;
+
+template <>
+const char rn2xx3_layout<sizeof(rn2xx3)>::tag;
+
+extern template class rn2xx3_t<Stream>;
+
+#endif
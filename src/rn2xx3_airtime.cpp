@@ -0,0 +1,173 @@
+/*
+ * Time on air and duty cycle bookkeeping for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_airtime.h"
+
+// MHDR, FHDR without options, FPort and MIC
+#define LORAWAN_OVERHEAD 13
+
+uint32_t rn2xx3_airtime::lora(uint8_t sf, uint16_t bwKHz, uint8_t cr, uint16_t preamble, uint16_t payload, bool crc)
+{
+  // Symbol time in microseconds, exact for 125, 250 and 500 kHz
+  uint32_t symbol = (1000UL << sf) / bwKHz;
+
+  // Low data rate optimisation is mandated above 16 ms per symbol
+  uint8_t lowDataRate = symbol > 16000 ? 1 : 0;
+
+  // Preamble of preamble + 4.25 symbols
+  uint32_t preambleTime = (4UL * preamble + 17) * symbol / 4;
+
+  long bits = 8L * payload - 4L * sf + 28 + (crc ? 16 : 0);
+  uint16_t symbols = 8;
+  if (bits > 0)
+  {
+    long perBlock = 4L * (sf - 2 * lowDataRate);
+    symbols += (bits + perBlock - 1) / perBlock * (cr + 4);
+  }
+  return preambleTime + symbols * symbol;
+}
+
+bool rn2xx3_airtime::dataRate(bool us915, uint8_t dr, uint8_t &sf, uint16_t &bwKHz)
+{
+  if (us915)
+  {
+    if (dr <= 3)
+    {
+      sf = 10 - dr;
+      bwKHz = 125;
+    }
+    else if (dr == 4)
+    {
+      sf = 8;
+      bwKHz = 500;
+    }
+    else if (dr >= 8 && dr <= 13)
+    {
+      sf = 20 - dr;
+      bwKHz = 500;
+    }
+    else
+      return false;
+  }
+  else
+  {
+    if (dr <= 5)
+    {
+      sf = 12 - dr;
+      bwKHz = 125;
+    }
+    else if (dr == 6)
+    {
+      sf = 7;
+      bwKHz = 250;
+    }
+    else
+      return false;
+  }
+  return true;
+}
+
+uint32_t rn2xx3_airtime::lorawan(bool us915, uint8_t dr, uint16_t payload)
+{
+  uint8_t sf;
+  uint16_t bw;
+  if (!dataRate(us915, dr, sf, bw))
+  {
+    // EU868 DR7 is FSK at 50 kbps: 5 bytes preamble, 3 sync, length and CRC
+    return (5 + 3 + 1 + LORAWAN_OVERHEAD + payload + 2) * 160UL;
+  }
+  return lora(sf, bw, 1, 8, LORAWAN_OVERHEAD + payload);
+}
+
+uint8_t rn2xx3_airtime::maxPayload(bool us915, uint8_t dr)
+{
+  if (us915)
+  {
+    static const uint8_t max[] PROGMEM = {11, 53, 125, 242, 242};
+    return dr <= 4 ? pgm_read_byte(&max[dr]) : 242;
+  }
+  return dr <= 2 ? 51 : dr == 3 ? 115 : 222;
+}
+
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+void rn2xx3_dutycycle::reset()
+{
+  for (uint8_t ch = 0; ch < RN2XX3_DUTY_CYCLE_CHANNELS; ch++)
+  {
+    _freeAt[ch] = 0;
+    _dcycle[ch] = 302;
+  }
+  _enabled = 0x0007;
+  _closed = 0;
+}
+
+void rn2xx3_dutycycle::setDutyCycle(uint8_t channel, uint16_t dcycle)
+{
+  if (channel < RN2XX3_DUTY_CYCLE_CHANNELS)
+    _dcycle[channel] = dcycle;
+}
+
+void rn2xx3_dutycycle::setEnabled(uint8_t channel, bool enabled)
+{
+  if (channel >= RN2XX3_DUTY_CYCLE_CHANNELS)
+    return;
+  if (enabled)
+    _enabled |= 1 << channel;
+  else
+    _enabled &= ~(1 << channel);
+}
+
+void rn2xx3_dutycycle::recordUplink(unsigned long nowMs, uint32_t airtimeUs)
+{
+  int8_t used = -1;
+  for (uint8_t ch = 0; ch < RN2XX3_DUTY_CYCLE_CHANNELS; ch++)
+  {
+    uint16_t mask = 1 << ch;
+    if (!(_enabled & mask))
+      continue;
+    if ((_closed & mask) && (long)(_freeAt[ch] - nowMs) <= 0)
+      _closed &= ~mask;
+
+    if (_closed & mask)
+    {
+      // The module found a free channel where the ledger did not, so the
+      // ledger is behind: take the channel that opens first.
+      if (used < 0 || ((_closed & (1 << used)) && (long)(_freeAt[ch] - _freeAt[used]) < 0))
+        used = ch;
+    }
+    else if (used < 0 || (_closed & (1 << used)) || _dcycle[ch] > _dcycle[used])
+    {
+      used = ch;
+    }
+  }
+  if (used < 0)
+    return;
+
+  // Closed for the transmission itself plus dcycle times its time on air
+  uint32_t airtimeMs = (airtimeUs + 999) / 1000;
+  _freeAt[used] = nowMs + airtimeMs * ((uint32_t)_dcycle[used] + 1);
+  _closed |= 1 << used;
+}
+
+unsigned long rn2xx3_dutycycle::nextFreeAt(unsigned long nowMs) const
+{
+  unsigned long next = nowMs;
+  bool found = false;
+  for (uint8_t ch = 0; ch < RN2XX3_DUTY_CYCLE_CHANNELS; ch++)
+  {
+    uint16_t mask = 1 << ch;
+    if (!(_enabled & mask))
+      continue;
+    long wait = (_closed & mask) ? (long)(_freeAt[ch] - nowMs) : 0;
+    if (wait <= 0)
+      return nowMs;
+    if (!found || (long)(_freeAt[ch] - next) < 0)
+      next = _freeAt[ch];
+    found = true;
+  }
+  return next;
+}
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Time on air and duty cycle bookkeeping for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_airtime_h
+#define rn2xx3_airtime_h
+
+#include "Arduino.h"
+
+/*
+ * Channels tracked by the duty cycle ledger (max 16, the RN2483 has no
+ * more). The EU frequency plans only use the first 8, so AVR boards save
+ * RAM by not tracking the others. 0 leaves the ledger out.
+ */
+#ifndef RN2XX3_DUTY_CYCLE_CHANNELS
+#ifdef __AVR__
+#define RN2XX3_DUTY_CYCLE_CHANNELS 8
+#else
+#define RN2XX3_DUTY_CYCLE_CHANNELS 16
+#endif
+#endif
+
+// The channel states are bits of a uint16_t
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 16
+#error "RN2XX3_DUTY_CYCLE_CHANNELS can be at most 16"
+#endif
+
+/*
+ * Time on air of LoRa packets, following Semtech AN1200.13.
+ */
+class rn2xx3_airtime
+{
+public:
+  /*
+     * Time on air in microseconds of a packet with an explicit header.
+     *
+     * sf - spreading factor, 7 to 12
+     * bwKHz - bandwidth: 125, 250 or 500
+     * cr - coding rate 4/(4 + cr), so 1 for 4/5 up to 4 for 4/8
+     * preamble - preamble length in symbols
+     * payload - PHY payload length in bytes
+     */
+  static uint32_t lora(uint8_t sf, uint16_t bwKHz, uint8_t cr, uint16_t preamble, uint16_t payload, bool crc = true);
+
+  /*
+     * The spreading factor and bandwidth of a LoRaWAN data rate, for the
+     * EU868 band of the RN2483 or the US915 band of the RN2903.
+     * Returns false for data rates that are not LoRa modulated.
+     */
+  static bool dataRate(bool us915, uint8_t dr, uint8_t &sf, uint16_t &bwKHz);
+
+  /*
+     * Time on air in microseconds of a LoRaWAN uplink carrying payload
+     * application bytes, without MAC commands.
+     */
+  static uint32_t lorawan(bool us915, uint8_t dr, uint16_t payload);
+
+  /*
+     * The largest application payload at a LoRaWAN data rate, without
+     * MAC commands.
+     */
+  static uint8_t maxPayload(bool us915, uint8_t dr);
+};
+
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+/*
+ * Ledger of the duty cycle of the channels of an RN2483.
+ *
+ * After an uplink the RN2483 keeps its channel closed for dcycle times the
+ * time on air. The module picks a random free channel and does not tell
+ * which, so the ledger assumes it took the free channel that stays closed
+ * the longest. Predictions are therefore never earlier than the module.
+ */
+class rn2xx3_dutycycle
+{
+public:
+  rn2xx3_dutycycle() { reset(); }
+
+  // The channels after "mac reset": 0 to 2 enabled with dcycle 302
+  void reset();
+
+  void setDutyCycle(uint8_t channel, uint16_t dcycle);
+  void setEnabled(uint8_t channel, bool enabled);
+
+  // An uplink of airtimeUs started at nowMs
+  void recordUplink(unsigned long nowMs, uint32_t airtimeUs);
+
+  /*
+     * The millis() value at which an enabled channel is free again,
+     * or nowMs when one is free already.
+     */
+  unsigned long nextFreeAt(unsigned long nowMs) const;
+
+private:
+  unsigned long _freeAt[RN2XX3_DUTY_CYCLE_CHANNELS];
+  uint16_t _dcycle[RN2XX3_DUTY_CYCLE_CHANNELS];
+  uint16_t _enabled;
+  uint16_t _closed;
+};
+#endif
+
+#endif
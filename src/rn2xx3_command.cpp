@@ -0,0 +1,129 @@
+/*
+ * The commands of a Microchip RN2xx3 LoRa radio, stored in program memory.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_command.h"
+#include "rn2xx3_hex.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+// One string in program memory per command
+#define RN2XX3_COMMAND_TEXT(id, text) static const char COMMAND_##id[] PROGMEM = text;
+RN2XX3_COMMANDS(RN2XX3_COMMAND_TEXT)
+#undef RN2XX3_COMMAND_TEXT
+
+// And a table of them, in the order of rn2xx3_command::id_t
+#define RN2XX3_COMMAND_ENTRY(id, text) COMMAND_##id,
+static const char *const COMMANDS[rn2xx3_command::COUNT] PROGMEM = {
+    RN2XX3_COMMANDS(RN2XX3_COMMAND_ENTRY)};
+#undef RN2XX3_COMMAND_ENTRY
+
+const __FlashStringHelper *rn2xx3_command::text(id_t id)
+{
+  return reinterpret_cast<const __FlashStringHelper *>(pgm_read_ptr(&COMMANDS[id]));
+}
+
+rn2xx3_command::rn2xx3_command(id_t id)
+    : _length(0), _hasArgs(false), _overflow(false)
+{
+  PGM_P prefix = reinterpret_cast<PGM_P>(text(id));
+  _length = strlen_P(prefix);
+  memcpy_P(_buffer, prefix, _length + 1);
+}
+
+void rn2xx3_command::separate()
+{
+  if (_hasArgs)
+    append(" ", 1);
+  _hasArgs = true;
+}
+
+void rn2xx3_command::append(const char *data, uint8_t length)
+{
+  if (_length + length >= sizeof(_buffer))
+  {
+    length = sizeof(_buffer) - 1 - _length;
+    _overflow = true;
+  }
+  memcpy(_buffer + _length, data, length);
+  _length += length;
+  _buffer[_length] = '\0';
+}
+
+rn2xx3_command &rn2xx3_command::arg(const __FlashStringHelper *value)
+{
+  separate();
+  PGM_P text = reinterpret_cast<PGM_P>(value);
+  size_t length = strlen_P(text);
+  if (_length + length >= sizeof(_buffer))
+  {
+    length = sizeof(_buffer) - 1 - _length;
+    _overflow = true;
+  }
+  memcpy_P(_buffer + _length, text, length);
+  _length += length;
+  _buffer[_length] = '\0';
+  return *this;
+}
+
+rn2xx3_command &rn2xx3_command::arg(const char *value)
+{
+  separate();
+  size_t length = strlen(value);
+  append(value, length > 255 ? 255 : length);
+  return *this;
+}
+
+rn2xx3_command &rn2xx3_command::arg(const String &value)
+{
+  separate();
+  append(value.c_str(), value.length() > 255 ? 255 : value.length());
+  return *this;
+}
+
+rn2xx3_command &rn2xx3_command::arg(unsigned long value)
+{
+  // Digits from the back of a scratch buffer, without printf. 20 digits
+  // hold an unsigned long of 64 bits, as on the host.
+  char digits[20];
+  uint8_t first = sizeof(digits);
+  do
+  {
+    digits[--first] = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+
+  separate();
+  append(digits + first, sizeof(digits) - first);
+  return *this;
+}
+
+rn2xx3_command &rn2xx3_command::arg(long value)
+{
+  if (value >= 0)
+    return arg((unsigned long)value);
+
+  separate();
+  append("-", 1);
+  _hasArgs = false; // the digits directly follow the sign
+  return arg(0UL - (unsigned long)value);
+}
+
+rn2xx3_command &rn2xx3_command::argHex(const uint8_t *data, uint8_t length)
+{
+  separate();
+  if ((size_t)_length + length * 2 >= sizeof(_buffer))
+  {
+    length = (sizeof(_buffer) - 1 - _length) / 2;
+    _overflow = true;
+  }
+  rn2xx3_hex::encode(_buffer + _length, data, length);
+  _length += length * 2;
+  _buffer[_length] = '\0';
+  return *this;
+}
@@ -0,0 +1,135 @@
+/*
+ * The commands of a Microchip RN2xx3 LoRa radio, stored in program memory.
+ *
+ */
+
+#ifndef rn2xx3_command_h
+#define rn2xx3_command_h
+
+#include "Arduino.h"
+
+/*
+ * Longest command composed by the library: "mac set appkey " followed by
+ * 32 HEX digits. Payloads of "mac tx" and "radio tx" are not composed,
+ * they are written straight to the stream.
+ */
+#define RN2XX3_COMMAND_SIZE 64
+
+/*
+ * Every command the library sends. Names ending in a space are prefixes
+ * that take arguments, the others are complete commands.
+ */
+#define RN2XX3_COMMANDS(X)                      \
+  X(SYS_GET_VER, "sys get ver")                 \
+  X(SYS_GET_HWEUI, "sys get hweui")             \
+  X(SYS_GET_VDD, "sys get vdd")                 \
+  X(SYS_RESET, "sys reset")                     \
+  X(SYS_SLEEP, "sys sleep ")                    \
+  X(MAC_RESET, "mac reset")                     \
+  X(MAC_RESET_BAND, "mac reset ")               \
+  X(MAC_PAUSE, "mac pause")                     \
+  X(MAC_RESUME, "mac resume")                   \
+  X(MAC_SAVE, "mac save")                       \
+  X(MAC_JOIN_OTAA, "mac join otaa")             \
+  X(MAC_JOIN_ABP, "mac join abp")               \
+  X(MAC_TX_CNF, "mac tx cnf 1 ")                \
+  X(MAC_TX_UNCNF, "mac tx uncnf 1 ")            \
+  X(MAC_GET_APPEUI, "mac get appeui")           \
+  X(MAC_GET_DEVEUI, "mac get deveui")           \
+  X(MAC_GET_DEVADDR, "mac get devaddr")         \
+  X(MAC_GET_UPCTR, "mac get upctr")             \
+  X(MAC_GET_DNCTR, "mac get dnctr")             \
+  X(MAC_GET_STATUS, "mac get status")           \
+  X(MAC_GET_DR, "mac get dr")                   \
+  X(MAC_GET_MRGN, "mac get mrgn")               \
+  X(MAC_GET_GWNB, "mac get gwnb")               \
+  X(MAC_SET_DEVEUI, "mac set deveui ")          \
+  X(MAC_SET_APPEUI, "mac set appeui ")          \
+  X(MAC_SET_APPKEY, "mac set appkey ")          \
+  X(MAC_SET_DEVADDR, "mac set devaddr ")        \
+  X(MAC_SET_NWKSKEY, "mac set nwkskey ")        \
+  X(MAC_SET_APPSKEY, "mac set appskey ")        \
+  X(MAC_SET_DR, "mac set dr ")                  \
+  X(MAC_SET_PWRIDX, "mac set pwridx ")          \
+  X(MAC_SET_ADR, "mac set adr ")                \
+  X(MAC_SET_AR, "mac set ar ")                  \
+  X(MAC_SET_LINKCHK, "mac set linkchk ")        \
+  X(MAC_SET_RX2, "mac set rx2 ")                \
+  X(MAC_SET_CH_DCYCLE, "mac set ch dcycle ")    \
+  X(MAC_SET_CH_FREQ, "mac set ch freq ")        \
+  X(MAC_SET_CH_DRRANGE, "mac set ch drrange ")  \
+  X(MAC_SET_CH_STATUS, "mac set ch status ")    \
+  X(RADIO_SET_MOD, "radio set mod ")            \
+  X(RADIO_SET_FREQ, "radio set freq ")          \
+  X(RADIO_SET_PWR, "radio set pwr ")            \
+  X(RADIO_SET_SF, "radio set sf ")              \
+  X(RADIO_SET_AFCBW, "radio set afcbw ")        \
+  X(RADIO_SET_RXBW, "radio set rxbw ")          \
+  X(RADIO_SET_PRLEN, "radio set prlen ")        \
+  X(RADIO_SET_CRC, "radio set crc ")            \
+  X(RADIO_SET_IQI, "radio set iqi ")            \
+  X(RADIO_SET_CR, "radio set cr ")              \
+  X(RADIO_SET_SYNC, "radio set sync ")          \
+  X(RADIO_SET_BW, "radio set bw ")              \
+  X(RADIO_GET_SNR, "radio get snr")             \
+  X(RADIO_RX, "radio rx ")                      \
+  X(RADIO_RXSTOP, "radio rxstop")               \
+  X(RADIO_TX, "radio tx ")
+
+/*
+ * A command line composed from an entry of the command table and its
+ * arguments, in a fixed buffer on the stack. Arguments are formatted
+ * directly into the buffer, without String temporaries.
+ */
+class rn2xx3_command
+{
+public:
+#define RN2XX3_COMMAND_ID(id, text) id,
+  enum id_t
+  {
+    RN2XX3_COMMANDS(RN2XX3_COMMAND_ID)
+        COUNT
+  };
+#undef RN2XX3_COMMAND_ID
+
+  /*
+     * The text of a table entry, in program memory.
+     */
+  static const __FlashStringHelper *text(id_t id);
+
+  explicit rn2xx3_command(id_t id);
+
+  /*
+     * Append an argument. Arguments after the first are separated by a
+     * space, the first one follows the space at the end of the prefix.
+     */
+  rn2xx3_command &arg(const __FlashStringHelper *value);
+  rn2xx3_command &arg(const char *value);
+  rn2xx3_command &arg(const String &value);
+  rn2xx3_command &arg(unsigned long value);
+  rn2xx3_command &arg(long value);
+  rn2xx3_command &arg(unsigned int value) { return arg((unsigned long)value); }
+  rn2xx3_command &arg(int value) { return arg((long)value); }
+  rn2xx3_command &argOnOff(bool on) { return arg(on ? F("on") : F("off")); }
+  rn2xx3_command &argHex(const uint8_t *data, uint8_t length);
+
+  const char *c_str() const { return _buffer; }
+  uint8_t length() const { return _length; }
+
+  /*
+     * True when the arguments did not fit, the command is then truncated.
+     * rn2xx3 does not send such a command, it fails like a refused one.
+     */
+  bool overflowed() const { return _overflow; }
+
+private:
+  void separate();
+  void append(const char *data, uint8_t length);
+
+  char _buffer[RN2XX3_COMMAND_SIZE];
+  uint8_t _length;
+  bool _hasArgs;
+  bool _overflow;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Link margin driven data rate control for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_datarate.h"
+#include "rn2xx3_airtime.h"
+
+// Floor of data rates that are not LoRa modulated, so they are never chosen
+#define NOT_LORA 32767
+
+rn2xx3_datarate::rn2xx3_datarate()
+    : _next(0), _count(0), _lost(false), _us915(false), _minDr(0), _maxDr(5), _targetMargin(5)
+{
+}
+
+void rn2xx3_datarate::configure(bool us915, uint8_t minDr, uint8_t maxDr, uint8_t targetMargin)
+{
+  _us915 = us915;
+  _minDr = minDr;
+  _maxDr = maxDr < minDr ? minDr : maxDr;
+  _targetMargin = targetMargin;
+}
+
+void rn2xx3_datarate::reset()
+{
+  _next = 0;
+  _count = 0;
+  _lost = false;
+}
+
+int16_t rn2xx3_datarate::demodulationFloor(bool us915, uint8_t dr)
+{
+  uint8_t sf;
+  uint16_t bwKHz;
+  if (!rn2xx3_airtime::dataRate(us915, dr, sf, bwKHz))
+    return NOT_LORA;
+
+  // SX1276 datasheet, table 13: -7.5 dB at SF7 down to -20 dB at SF12
+  int16_t floor = -75 - 25 * (sf - 7);
+  if (bwKHz == 250)
+    floor += 30;
+  else if (bwKHz == 500)
+    floor += 60;
+  return floor;
+}
+
+void rn2xx3_datarate::add(int16_t snr)
+{
+  _snr[_next] = snr;
+  _next = (_next + 1) % RN2XX3_LINK_HISTORY;
+  if (_count < RN2XX3_LINK_HISTORY)
+    _count++;
+}
+
+void rn2xx3_datarate::addMargin(uint8_t dr, uint8_t margin)
+{
+  int16_t floor = demodulationFloor(_us915, dr);
+  if (floor != NOT_LORA)
+    add(floor + 10 * margin);
+}
+
+void rn2xx3_datarate::addSnr(int8_t snr)
+{
+  add(10 * snr);
+}
+
+void rn2xx3_datarate::addLoss()
+{
+  // What was measured before no longer describes the link
+  reset();
+  _lost = true;
+}
+
+uint8_t rn2xx3_datarate::below(uint8_t dr) const
+{
+  while (dr > _minDr)
+  {
+    dr--;
+    if (demodulationFloor(_us915, dr) != NOT_LORA)
+      return dr;
+  }
+  return _minDr;
+}
+
+uint8_t rn2xx3_datarate::choose(uint8_t current)
+{
+  if (current > _maxDr)
+    current = _maxDr;
+  if (current < _minDr)
+    current = _minDr;
+
+  if (_lost)
+  {
+    _lost = false;
+    return below(current);
+  }
+  if (_count == 0)
+    return current;
+
+  int16_t worst = _snr[0];
+  for (uint8_t i = 1; i < _count; i++)
+  {
+    if (_snr[i] < worst)
+      worst = _snr[i];
+  }
+
+  // The floor rises with the data rate, so the last one that fits is the fastest
+  uint8_t best = _minDr;
+  for (uint8_t dr = _minDr; dr <= _maxDr; dr++)
+  {
+    int16_t floor = demodulationFloor(_us915, dr);
+    if (floor != NOT_LORA && worst - floor >= 10 * _targetMargin)
+      best = dr;
+  }
+
+  if (best > current && _count < RN2XX3_LINK_SAMPLES_TO_RAISE)
+    return current;
+  return best;
+}
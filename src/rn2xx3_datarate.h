@@ -0,0 +1,87 @@
+/*
+ * Link margin driven data rate control for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_datarate_h
+#define rn2xx3_datarate_h
+
+#include "Arduino.h"
+
+// Link measurements the choice is based on
+#ifndef RN2XX3_LINK_HISTORY
+#define RN2XX3_LINK_HISTORY 8
+#endif
+
+// Measurements needed before the data rate is raised
+#ifndef RN2XX3_LINK_SAMPLES_TO_RAISE
+#define RN2XX3_LINK_SAMPLES_TO_RAISE 3
+#endif
+
+/*
+ * Chooses the fastest LoRaWAN data rate that keeps a target link margin,
+ * from a window of recent link measurements.
+ *
+ * The measurements are kept as the SNR of the link, whatever data rate
+ * they were taken at. A link check answer gives the margin above the
+ * demodulation floor of the uplink, so the SNR is the margin plus that
+ * floor. Each step of spreading factor moves the floor by 2.5 dB, and
+ * doubling the bandwidth raises it by 3 dB.
+ *
+ * The data rate is lowered as soon as one measurement asks for it, but
+ * only raised once RN2XX3_LINK_SAMPLES_TO_RAISE measurements agree.
+ */
+class rn2xx3_datarate
+{
+public:
+  rn2xx3_datarate();
+
+  /*
+     * The data rates to choose from, for the EU868 band of the RN2483 or
+     * the US915 band of the RN2903, and the margin in dB to keep above
+     * the demodulation floor. Keeps the measurements.
+     */
+  void configure(bool us915, uint8_t minDr, uint8_t maxDr, uint8_t targetMargin);
+
+  // Forget all measurements
+  void reset();
+
+  // A link check answer for an uplink sent at dr
+  void addMargin(uint8_t dr, uint8_t margin);
+
+  // The SNR in dB of a received downlink
+  void addSnr(int8_t snr);
+
+  // A link check that no gateway answered
+  void addLoss();
+
+  uint8_t count() const { return _count; }
+
+  /*
+     * The data rate to use next, given the one in use. Without
+     * measurements that is current, limited to the configured range.
+     */
+  uint8_t choose(uint8_t current);
+
+  /*
+     * The lowest SNR in tenths of dB at which a data rate can be
+     * received, relative to a 125 kHz channel.
+     * Returns a very high floor for data rates that are not LoRa.
+     */
+  static int16_t demodulationFloor(bool us915, uint8_t dr);
+
+private:
+  void add(int16_t snr);
+  uint8_t below(uint8_t dr) const;
+
+  int16_t _snr[RN2XX3_LINK_HISTORY]; // in tenths of dB
+  uint8_t _next;
+  uint8_t _count;
+  bool _lost;
+  bool _us915;
+  uint8_t _minDr;
+  uint8_t _maxDr;
+  uint8_t _targetMargin;
+};
+
+#endif
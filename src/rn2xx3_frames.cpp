@@ -0,0 +1,86 @@
+/*
+ * Ring of received P2P frames for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_frames.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+#if RN2XX3_FRAME_RING_BYTES > 0
+rn2xx3_frames::rn2xx3_frames()
+    : _head(0), _used(0), _first(0), _count(0), _dropped(0), _overflowed(0)
+{
+}
+
+bool rn2xx3_frames::push(const uint8_t *data, uint16_t length, unsigned long at)
+{
+  if (length > RN2XX3_FRAME_RING_BYTES)
+  {
+    _overflowed++;
+    return false;
+  }
+  if (_count == RN2XX3_FRAME_RING_ENTRIES || _used + length > RN2XX3_FRAME_RING_BYTES)
+  {
+    _dropped++;
+    return false;
+  }
+
+  // Copy in up to two parts, around the end of the ring
+  uint16_t tail = (_head + _used) % RN2XX3_FRAME_RING_BYTES;
+  uint16_t part = RN2XX3_FRAME_RING_BYTES - tail;
+  if (part > length)
+    part = length;
+  memcpy(_bytes + tail, data, part);
+  memcpy(_bytes, data + part, length - part);
+  _used += length;
+
+  rn2xx3_frame_info &info = _info[(_first + _count) % RN2XX3_FRAME_RING_ENTRIES];
+  info.length = length;
+  info.at = at;
+  info.snr = RN2XX3_SNR_UNKNOWN;
+  _count++;
+  return true;
+}
+
+void rn2xx3_frames::setSnr(int8_t snr)
+{
+  if (_count > 0)
+    _info[(_first + _count - 1) % RN2XX3_FRAME_RING_ENTRIES].snr = snr;
+}
+
+uint8_t rn2xx3_frames::pop(uint8_t *buffer, uint16_t size, rn2xx3_frame_info *info, uint8_t max)
+{
+  uint8_t taken = 0;
+  uint16_t written = 0;
+  while (taken < max && _count > 0)
+  {
+    const rn2xx3_frame_info &oldest = _info[_first];
+    uint16_t copy = oldest.length;
+    if (written + copy > size)
+    {
+      if (taken > 0)
+        break;
+      copy = size;
+    }
+
+    uint16_t part = RN2XX3_FRAME_RING_BYTES - _head;
+    if (part > copy)
+      part = copy;
+    memcpy(buffer + written, _bytes + _head, part);
+    memcpy(buffer + written + part, _bytes, copy - part);
+    written += copy;
+
+    info[taken++] = oldest;
+    _head = (_head + oldest.length) % RN2XX3_FRAME_RING_BYTES;
+    _used -= oldest.length;
+    _first = (_first + 1) % RN2XX3_FRAME_RING_ENTRIES;
+    _count--;
+  }
+  return taken;
+}
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Ring of received P2P frames for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_frames_h
+#define rn2xx3_frames_h
+
+#include "Arduino.h"
+
+// Room for the bytes of the frames waiting to be read, 0 for no ring
+#ifndef RN2XX3_FRAME_RING_BYTES
+#ifdef __AVR__
+#define RN2XX3_FRAME_RING_BYTES 64
+#else
+#define RN2XX3_FRAME_RING_BYTES 512
+#endif
+#endif
+
+#ifndef RN2XX3_FRAME_RING_ENTRIES
+#ifdef __AVR__
+#define RN2XX3_FRAME_RING_ENTRIES 4
+#else
+#define RN2XX3_FRAME_RING_ENTRIES 16
+#endif
+#endif
+
+// SNR of a frame for which the RN2xx3 did not report one
+#define RN2XX3_SNR_UNKNOWN -128
+
+struct rn2xx3_frame_info
+{
+  uint16_t length;
+  unsigned long at; // millis() when the frame was received
+  int8_t snr;       // in dB
+};
+
+#if RN2XX3_FRAME_RING_BYTES > 0
+/*
+ * The frames are stored back to back in one byte ring, so short frames
+ * do not take the room of the longest possible one. When the ring is
+ * full new frames are dropped, the oldest are kept.
+ */
+class rn2xx3_frames
+{
+public:
+  rn2xx3_frames();
+
+  /*
+     * Store a frame received at millis() value at, with an unknown SNR.
+     * Returns false when the ring has no room for it.
+     */
+  bool push(const uint8_t *data, uint16_t length, unsigned long at);
+
+  // Set the SNR of the newest frame
+  void setSnr(int8_t snr);
+
+  uint8_t count() const { return _count; }
+
+  /*
+     * Take up to max of the oldest frames, copied back to back into
+     * buffer, as long as they fit. Returns the number taken, with their
+     * lengths in info. When even the first frame does not fit it is taken
+     * anyway, cut off at size bytes; its info holds the original length.
+     */
+  uint8_t pop(uint8_t *buffer, uint16_t size, rn2xx3_frame_info *info, uint8_t max);
+
+  // Frames lost because the ring was full
+  unsigned long dropped() const { return _dropped; }
+
+  // Frames lost because they were longer than the ring or a receive buffer
+  unsigned long overflowed() const { return _overflowed; }
+  void countOverflow() { _overflowed++; }
+
+private:
+  uint8_t _bytes[RN2XX3_FRAME_RING_BYTES];
+  rn2xx3_frame_info _info[RN2XX3_FRAME_RING_ENTRIES];
+  uint16_t _head; // offset of the first byte of the oldest frame
+  uint16_t _used;
+  uint8_t _first; // index of the info of the oldest frame
+  uint8_t _count;
+  unsigned long _dropped;
+  unsigned long _overflowed;
+};
+#endif
+
+#endif
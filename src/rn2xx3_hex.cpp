@@ -0,0 +1,237 @@
+/*
+ * Base16 codec for the HEX payloads of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_hex.h"
+
+extern "C"
+{
+#include <stdint.h>
+}
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Word at a time conversion where registers are at least 32 bits wide
+#if UINTPTR_MAX > 0xFFFF
+#define RN2XX3_HEX_WORDS
+#endif
+
+static const char DIGITS_UPPER[] PROGMEM = "0123456789ABCDEF";
+static const char DIGITS_LOWER[] PROGMEM = "0123456789abcdef";
+
+// Value of the characters '0' to 'f', 0xFF when it is not a HEX digit
+#define X 0xFF
+static const uint8_t NIBBLES['f' - '0' + 1] PROGMEM = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15};
+#undef X
+
+static inline uint8_t nibbleValue(uint8_t c)
+{
+  uint8_t index = c - '0';
+  if (index > 'f' - '0')
+    return 0xFF;
+  return pgm_read_byte(&NIBBLES[index]);
+}
+
+int8_t rn2xx3_hex::nibble(char c)
+{
+  uint8_t value = nibbleValue(c);
+  return value == 0xFF ? -1 : value;
+}
+
+void rn2xx3_hex::encode(char *out, const uint8_t *data, size_t length, bool lowercase)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i low = _mm_set1_epi8(0x0F);
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i letters = _mm_set1_epi8(lowercase ? 'a' - '0' - 10 : 'A' - '0' - 10);
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(data + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), low);
+    __m128i lo = _mm_and_si128(bytes, low);
+    hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letters));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letters));
+    _mm_storeu_si128((__m128i *)(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128((__m128i *)(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+#endif
+
+#if defined(RN2XX3_HEX_WORDS)
+  // Two bytes become four digits: spread the nibbles over the bytes of a
+  // word, then add '0' and, for nibbles above 9, the offset to the letters.
+  const uint32_t letter = lowercase ? 0x27 : 0x07;
+  for (; i + 2 <= length; i += 2)
+  {
+    uint32_t a = data[i];
+    uint32_t b = data[i + 1];
+    uint32_t nibbles = (a >> 4) | ((a & 0x0F) << 8) | ((b >> 4) << 16) | ((b & 0x0F) << 24);
+    uint32_t above9 = ((nibbles + 0x06060606) >> 4) & 0x01010101;
+    uint32_t digits = nibbles + 0x30303030 + above9 * letter;
+    out[i * 2] = (char)digits;
+    out[i * 2 + 1] = (char)(digits >> 8);
+    out[i * 2 + 2] = (char)(digits >> 16);
+    out[i * 2 + 3] = (char)(digits >> 24);
+  }
+#endif
+
+  const char *table = lowercase ? DIGITS_LOWER : DIGITS_UPPER;
+  for (; i < length; i++)
+  {
+    out[i * 2] = pgm_read_byte(&table[data[i] >> 4]);
+    out[i * 2 + 1] = pgm_read_byte(&table[data[i] & 0x0F]);
+  }
+}
+
+void rn2xx3_hex::encodeInPlace(uint8_t *buffer, size_t length, bool lowercase)
+{
+  // Back to front, so every byte is read before its digits overwrite it
+  const char *table = lowercase ? DIGITS_LOWER : DIGITS_UPPER;
+  for (size_t i = length; i-- > 0;)
+  {
+    uint8_t value = buffer[i];
+    buffer[i * 2] = pgm_read_byte(&table[value >> 4]);
+    buffer[i * 2 + 1] = pgm_read_byte(&table[value & 0x0F]);
+  }
+}
+
+bool rn2xx3_hex::decode(uint8_t *out, const char *hex, size_t hexLength)
+{
+  if (hexLength & 1)
+    return false;
+
+  const size_t length = hexLength / 2;
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128i zeroBelow = _mm_set1_epi8('0' - 1);
+  const __m128i nineAbove = _mm_set1_epi8('9' + 1);
+  const __m128i aBelow = _mm_set1_epi8('a' - 1);
+  const __m128i fAbove = _mm_set1_epi8('f' + 1);
+  const __m128i caseBit = _mm_set1_epi8(0x20);
+  const __m128i low = _mm_set1_epi16(0x00FF);
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i values[2];
+    for (int half = 0; half < 2; half++)
+    {
+      __m128i c = _mm_loadu_si128((const __m128i *)(hex + i * 2 + half * 16));
+      __m128i folded = _mm_or_si128(c, caseBit);
+      // Bytes above 0x7F are negative, so they fail both range checks
+      __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(c, zeroBelow), _mm_cmplt_epi8(c, nineAbove));
+      __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(folded, aBelow), _mm_cmplt_epi8(folded, fAbove));
+      if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF)
+        return false;
+      __m128i digit = _mm_and_si128(isDigit, _mm_sub_epi8(c, _mm_set1_epi8('0')));
+      __m128i letter = _mm_and_si128(isLetter, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10)));
+      __m128i nibbles = _mm_or_si128(digit, letter);
+      // Each 16 bit lane holds the high nibble in its first byte
+      values[half] = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, low), 4), _mm_srli_epi16(nibbles, 8));
+    }
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(values[0], values[1]));
+  }
+#endif
+
+#if defined(RN2XX3_HEX_WORDS)
+  // Four digits at a time. Every byte of the word is checked to be below
+  // 0x80, which leaves room to compare all four against the ranges of
+  // digits and letters with a single addition each.
+  for (; i + 2 <= length; i += 2)
+  {
+    const uint8_t *c = (const uint8_t *)hex + i * 2;
+    uint32_t word = (uint32_t)c[0] | ((uint32_t)c[1] << 8) | ((uint32_t)c[2] << 16) | ((uint32_t)c[3] << 24);
+    uint32_t folded = word | 0x20202020;
+    uint32_t isDigit = (word + 0x50505050) & ~(word + 0x46464646);
+    uint32_t isLetter = (folded + 0x1F1F1F1F) & ~(folded + 0x19191919);
+    if ((word & 0x80808080) || ((isDigit | isLetter) & 0x80808080) != 0x80808080)
+      return false;
+    uint32_t nibbles = (word & 0x0F0F0F0F) + ((isLetter >> 7) & 0x01010101) * 9;
+    uint32_t bytes = ((nibbles & 0x000F000F) << 4) | ((nibbles >> 8) & 0x000F000F);
+    out[i] = (uint8_t)bytes;
+    out[i + 1] = (uint8_t)(bytes >> 16);
+  }
+#endif
+
+  for (; i < length; i++)
+  {
+    uint8_t hi = nibbleValue(hex[i * 2]);
+    uint8_t lo = nibbleValue(hex[i * 2 + 1]);
+    if ((hi | lo) & 0xF0)
+      return false;
+    out[i] = (hi << 4) | lo;
+  }
+  return true;
+}
+
+int rn2xx3_hex::decodeInPlace(char *buffer, size_t hexLength)
+{
+  // Every block is read before the bytes are stored, at or before its start
+  if (!decode((uint8_t *)buffer, buffer, hexLength))
+    return -1;
+  return hexLength / 2;
+}
+
+void rn2xx3_hex::decoder::reset()
+{
+  _pending = 0;
+  _half = false;
+  _error = false;
+}
+
+size_t rn2xx3_hex::decoder::write(uint8_t *out, const char *hex, size_t length)
+{
+  size_t written = 0;
+
+  // Complete a byte split over two pieces
+  if (_half && length > 0)
+  {
+    uint8_t lo = nibbleValue(*hex++);
+    length--;
+    if (lo & 0xF0)
+      _error = true;
+    else
+    {
+      out[written++] = (_pending << 4) | lo;
+      _half = false;
+    }
+  }
+
+  // The bulk of the piece, through the block decoder
+  size_t whole = length & ~(size_t)1;
+  if (!_half && whole > 0 && decode(out + written, hex, whole))
+  {
+    written += whole / 2;
+    hex += whole;
+    length -= whole;
+  }
+
+  // Invalid data or a trailing digit, one at a time
+  while (length > 0)
+  {
+    uint8_t value = nibbleValue(*hex++);
+    length--;
+    if (value & 0xF0)
+      _error = true;
+    else if (_half)
+    {
+      out[written++] = (_pending << 4) | value;
+      _half = false;
+    }
+    else
+    {
+      _pending = value;
+      _half = true;
+    }
+  }
+  return written;
+}
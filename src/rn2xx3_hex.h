@@ -0,0 +1,104 @@
+/*
+ * Base16 codec for the HEX payloads of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_hex_h
+#define rn2xx3_hex_h
+
+#include "Arduino.h"
+
+/*
+ * Encoding and decoding of base16 (HEX) data without printf or strtoul.
+ * 8-bit targets use nibble lookup tables, 32-bit targets convert a word at
+ * a time and host builds with SSE2 convert 16 bytes at a time.
+ */
+class rn2xx3_hex
+{
+public:
+  /*
+     * Write the 2 * length HEX digits of data to out, without terminator.
+     * Upper case unless lowercase is set.
+     */
+  static void encode(char *out, const uint8_t *data, size_t length, bool lowercase = false);
+
+  /*
+     * Encode the first length bytes of buffer in place.
+     * buffer must have room for 2 * length characters.
+     */
+  static void encodeInPlace(uint8_t *buffer, size_t length, bool lowercase = false);
+
+  /*
+     * Print the HEX digits of data to a stream, in small chunks from the
+     * stack, so no copy of the encoded data is made.
+     * Returns the number of characters written. out is any Print, or a
+     * serial port class with the same write(), whose writes can then be
+     * inlined.
+     */
+  template <class Output>
+  static size_t print(Output &out, const uint8_t *data, size_t length, bool lowercase = false);
+
+  /*
+     * Decode hexLength HEX digits to hexLength / 2 bytes.
+     * Returns false when hexLength is odd or a character is not a HEX
+     * digit, in which case the contents of out are undefined.
+     */
+  static bool decode(uint8_t *out, const char *hex, size_t hexLength);
+
+  /*
+     * Decode hexLength HEX digits in place, to the start of buffer.
+     * Returns the number of bytes, or -1 on invalid input.
+     */
+  static int decodeInPlace(char *buffer, size_t hexLength);
+
+  /*
+     * Value of a single HEX digit, or -1 when c is not a HEX digit.
+     */
+  static int8_t nibble(char c);
+
+  /*
+     * Decoder for HEX data that arrives in pieces, for example straight
+     * from a serial port. Pieces may split a byte in two.
+     */
+  class decoder
+  {
+  public:
+    decoder() { reset(); }
+
+    void reset();
+
+    /*
+       * Decode a piece of HEX data to out, which needs room for
+       * (length + 1) / 2 bytes. Returns the number of bytes written.
+       * Invalid digits are skipped and remembered in error().
+       */
+    size_t write(uint8_t *out, const char *hex, size_t length);
+
+    // True when all data so far was valid and no half byte is pending
+    bool finish() const { return !_error && !_half; }
+    bool error() const { return _error; }
+
+  private:
+    uint8_t _pending;
+    bool _half;
+    bool _error;
+  };
+};
+
+template <class Output>
+size_t rn2xx3_hex::print(Output &out, const uint8_t *data, size_t length, bool lowercase)
+{
+  char chunk[32];
+  size_t written = 0;
+  while (length > 0)
+  {
+    size_t bytes = length < sizeof(chunk) / 2 ? length : sizeof(chunk) / 2;
+    encode(chunk, data, bytes, lowercase);
+    written += out.write((const uint8_t *)chunk, bytes * 2);
+    data += bytes;
+    length -= bytes;
+  }
+  return written;
+}
+
+#endif
@@ -0,0 +1,2703 @@
+/*
+ * A library for controlling a Microchip rn2xx3 LoRa radio.
+ * The members of rn2xx3_t, included at the end of rn2xx3.h.
+ *
+ * @Author JP Meijers
+ * @Author Nicolas Schteinschraber
+ * @Date 18/12/2015
+ *
+ */
+
+#ifndef rn2xx3_impl_h
+#define rn2xx3_impl_h
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+#include "rn2xx3_hex.h"
+
+// Log records are only stored here, see flushLog()
+#if RN2XX3_LOG_LEVEL >= RN2XX3_LOG_ERROR
+#define RN2XX3_LOG_AT_ERROR(event, detail, value) _log.push(rn2xx3_log::event, (detail), (value))
+#else
+#define RN2XX3_LOG_AT_ERROR(event, detail, value) \
+  do                                              \
+  {                                               \
+  } while (0)
+#endif
+
+#if RN2XX3_LOG_LEVEL >= RN2XX3_LOG_INFO
+#define RN2XX3_LOG_AT_INFO(event, detail, value) _log.push(rn2xx3_log::event, (detail), (value))
+#else
+#define RN2XX3_LOG_AT_INFO(event, detail, value) \
+  do                                             \
+  {                                              \
+  } while (0)
+#endif
+
+#if RN2XX3_LOG_LEVEL >= RN2XX3_LOG_DEBUG
+#define RN2XX3_LOG_AT_DEBUG(event, detail, value) _log.push(rn2xx3_log::event, (detail), (value))
+#else
+#define RN2XX3_LOG_AT_DEBUG(event, detail, value) \
+  do                                              \
+  {                                               \
+  } while (0)
+#endif
+
+// Counting for getStats(), left out when RN2XX3_STATS is 0
+#if RN2XX3_STATS
+#define RN2XX3_STATS_DO(...) __VA_ARGS__
+#else
+#define RN2XX3_STATS_DO(...) \
+  do                         \
+  {                          \
+  } while (0)
+#endif
+
+extern "C"
+{
+#include <string.h>
+#include <stdlib.h>
+}
+
+/*
+  @param serial Needs to be an already opened serial port ({Software/Hardware}Serial) to write to and read from.
+*/
+template <class Transport>
+rn2xx3_t<Transport>::rn2xx3_t(Transport &serial, const char *layout) : _serial(serial)
+{
+  // Read, so link time optimisation keeps the caller's reference to it
+  (void)*(const volatile char *)layout;
+  memset(_downlinkHandlers, 0, sizeof(_downlinkHandlers));
+  _hweui[0] = '\0';
+  memset(_batchFailed, 0, sizeof(_batchFailed));
+  invalidateCache();
+  RN2XX3_STATS_DO(_stats.reset());
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::autobaud(unsigned long timeoutMs)
+{
+  unsigned long start = millis();
+  bool response = false;
+
+  // Long enough for "sys get ver" and its reply at this baud rate.
+  // A module that is still booting gets more time on each attempt.
+  unsigned long waitMs = 600000UL / _baud + 10;
+  while (true)
+  {
+    _serial.write((byte)0x00);
+    _serial.write(0x55);
+    _serial.println();
+    // we could use sendRawCommand(F("sys get ver")); here
+    _serial.println(rn2xx3_command::text(rn2xx3_command::SYS_GET_VER));
+    countWrite(6 + strlen_P(reinterpret_cast<PGM_P>(rn2xx3_command::text(rn2xx3_command::SYS_GET_VER))));
+
+    // The line ending after 0x55 may be answered first, skip to the banner
+    unsigned long sent = millis();
+    while (!response && millis() - sent < waitMs)
+      response = _reader.read(_serial, waitMs - (millis() - sent)).startsWith(F("RN2"));
+
+    if (response || millis() - start >= timeoutMs)
+      break;
+    waitMs = waitMs * 2 > 1000 ? 1000 : waitMs * 2;
+  }
+
+  _lastAutobaudTime = millis() - start;
+  return response;
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getLastAutobaudTime()
+{
+  return _lastAutobaudTime;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setBaudRate(unsigned long baud, rn2xx3_baud_callback_t callback)
+{
+  // Nothing may arrive at the old baud rate once the host switched
+  drainUnsolicited();
+
+  unsigned long previous = _baud;
+  callback(baud);
+  _baud = baud;
+  if (autobaud(2000))
+    return true;
+
+  callback(previous);
+  _baud = previous;
+  autobaud(2000);
+  return false;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::sysver()
+{
+  String ver = sendCommand(rn2xx3_command::SYS_GET_VER).c_str();
+  ver.trim();
+  return ver;
+}
+
+template <class Transport>
+RN2xx3_t rn2xx3_t<Transport>::configureModuleType()
+{
+  // The identity of the module does not change, ask only once
+  if (_moduleType != RN_NA)
+    return _moduleType;
+
+  rn2xx3_line version = sendCommand(rn2xx3_command::SYS_GET_VER);
+
+  // "RN2483 1.0.5 Oct 31 2018 15:06:52": the model number follows "RN"
+  char model[5] = "";
+  if (version.length >= 6)
+  {
+    memcpy(model, version.data + 2, 4);
+    model[4] = '\0';
+  }
+  switch (atoi(model))
+  {
+  case 2903:
+    _moduleType = RN2903;
+    break;
+  case 2483:
+    _moduleType = RN2483;
+    break;
+  default:
+    _moduleType = RN_NA;
+    break;
+  }
+  return _moduleType;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::hweui()
+{
+  if (_hweui[0] == '\0')
+  {
+    rn2xx3_line eui = sendCommand(rn2xx3_command::SYS_GET_HWEUI);
+    if (eui.length == 16)
+    {
+      memcpy(_hweui, eui.data, sizeof(_hweui));
+    }
+    else
+    {
+      return String(eui.c_str());
+    }
+  }
+  return String(_hweui);
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::appeui()
+{
+  return String(sendCommand(rn2xx3_command::MAC_GET_APPEUI).c_str());
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::appkey()
+{
+  // We can't read back from module, we send the one
+  // we have memorized if it has been set
+  return _appskey;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::deveui()
+{
+  return String(sendCommand(rn2xx3_command::MAC_GET_DEVEUI).c_str());
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::resume()
+{
+  _radio2radio = false;
+
+  //handle what is left in the serial buffer
+  drainUnsolicited();
+
+  if (configureModuleType() == RN_NA)
+    return false;
+
+  uint32_t status = readMacStatus();
+  if (status & (RN2XX3_MAC_STATUS_SILENT | RN2XX3_MAC_STATUS_REJOIN_NEEDED))
+  {
+    // only a new join helps
+    return false;
+  }
+  if (status & RN2XX3_MAC_STATUS_PAUSED)
+  {
+    sendCommand(rn2xx3_command::MAC_RESUME);
+  }
+  return status & RN2XX3_MAC_STATUS_JOINED;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::setSessionResume(bool enabled)
+{
+  _sessionResume = enabled;
+}
+
+template <class Transport>
+uint32_t rn2xx3_t<Transport>::getFrameCounterUp()
+{
+  return strtoul(sendCommand(rn2xx3_command::MAC_GET_UPCTR).c_str(), NULL, 10);
+}
+
+template <class Transport>
+uint32_t rn2xx3_t<Transport>::getFrameCounterDown()
+{
+  return strtoul(sendCommand(rn2xx3_command::MAC_GET_DNCTR).c_str(), NULL, 10);
+}
+
+template <class Transport>
+uint32_t rn2xx3_t<Transport>::readMacStatus()
+{
+  rn2xx3_line status = sendCommand(rn2xx3_command::MAC_GET_STATUS);
+  if (status.length == 0)
+    return 0;
+  return strtoul(status.c_str(), NULL, 16);
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::sameHex(rn2xx3_command::id_t command, const String &expected)
+{
+  rn2xx3_line value = sendCommand(command);
+  return value.length == expected.length() && strcasecmp(value.c_str(), expected.c_str()) == 0;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::resumeOTAA(const String &AppEUI, const String &DevEUI)
+{
+  if (!resume())
+    return false;
+
+  // Only continue the session if it belongs to the requested device
+  if (AppEUI.length() == 16 && !sameHex(rn2xx3_command::MAC_GET_APPEUI, AppEUI))
+    return false;
+  if (!sameHex(rn2xx3_command::MAC_GET_DEVEUI, DevEUI.length() == 16 ? DevEUI : hweui()))
+    return false;
+
+  RN2XX3_LOG_AT_INFO(RESUMED, 1, 0);
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::resumeABP(const String &devAddr)
+{
+  bool joined = resume();
+  if (_moduleType == RN_NA || !sameHex(rn2xx3_command::MAC_GET_DEVADDR, devAddr))
+    return false;
+  if (joined)
+  {
+    RN2XX3_LOG_AT_INFO(RESUMED, 0, 0);
+    return true;
+  }
+
+  // The module restarted, but still has the session saved by "mac save".
+  // Joining with ABP does not need the network, so this is quick.
+  // The frame counters continue from the last "mac save".
+  uint32_t status = readMacStatus();
+  if (status & (RN2XX3_MAC_STATUS_SILENT | RN2XX3_MAC_STATUS_REJOIN_NEEDED))
+    return false;
+
+  beginBatch();
+  setAdaptiveDataRate(false);
+  setAutomaticReply(_automaticReply);
+  applyLinkCheck();
+  setTXoutputPower(_moduleType == RN2903 ? 5 : 1);
+  setDR(initialDataRate());
+  endBatch();
+
+  sendCommand(rn2xx3_command::MAC_JOIN_ABP);
+  rn2xx3_line receivedData = _reader.read(_serial, 60000);
+  return determineReceivedDataType(receivedData) == rn2xx3_reply::accepted;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::forceInit()
+{
+  bool sessionResume = _sessionResume;
+  _sessionResume = false;
+  bool ret = init();
+  _sessionResume = sessionResume;
+  return ret;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::init()
+{
+  _radio2radio = false;
+  if (_appskey == "0") //appskey variable is set by both OTAA and ABP
+  {
+    return false;
+  }
+  else if (_otaa == true)
+  {
+    return initOTAA(_appeui, _appskey);
+  }
+  else
+  {
+    return initABP(_devAddr, _appskey, _nwkskey);
+  }
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::initP2P()
+{
+  return initP2P(rn2xx3_radio_profile());
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::initP2P(const rn2xx3_radio_profile &profile)
+{
+  sendCommand(rn2xx3_command::SYS_RESET);
+  invalidateCache();
+  _radio2radio = true;
+
+  // The reset put the RN2xx3 back at its default baud rate
+  if (_baud != RN2XX3_DEFAULT_BAUD)
+    autobaud();
+
+  //handle what is left in the serial buffer
+  drainUnsolicited();
+
+  switch (configureModuleType())
+  {
+  case RN2903:
+    RN2XX3_LOG_AT_INFO(FOUND_MODULE, 0, RN2903);
+    break;
+  case RN2483:
+    RN2XX3_LOG_AT_INFO(FOUND_MODULE, 0, RN2483);
+    break;
+  default:
+    // we shouldn't go forward with the init
+    return false;
+  }
+  sendCommand(rn2xx3_command::MAC_PAUSE);
+
+  beginBatch();
+  sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_AFCBW).arg(F("41.7")));
+  sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_RXBW).arg(125));
+  applyRadioProfile(profile);
+  endBatch();
+
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setRadioProfile(const rn2xx3_radio_profile &profile)
+{
+  if (!_radio2radio)
+    return false;
+
+  beginBatch();
+  applyRadioProfile(profile);
+  return endBatch() == 0;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::radioCacheHit(uint16_t setting, bool matches)
+{
+  return cacheHit((_radioKnown & setting) && matches);
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::applyRadioProfile(const rn2xx3_radio_profile &profile)
+{
+  // The modulation first, the other settings depend on it
+  if (!radioCacheHit(RADIO_KNOWN_MOD, _radio.fsk == profile.fsk) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_MOD).arg(profile.fsk ? F("fsk") : F("lora"))))
+  {
+    _radio.fsk = profile.fsk;
+    _radioKnown |= RADIO_KNOWN_MOD;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_FREQ, _radio.frequency == profile.frequency) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_FREQ).arg((unsigned long)profile.frequency)))
+  {
+    _radio.frequency = profile.frequency;
+    _radioKnown |= RADIO_KNOWN_FREQ;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_PWR, _radio.power == profile.power) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_PWR).arg(profile.power)))
+  {
+    _radio.power = profile.power;
+    _radioKnown |= RADIO_KNOWN_PWR;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_SF, _radio.sf == profile.sf))
+  {
+    // sf7 to sf12
+    char sf[5] = {'s', 'f', (char)('0' + profile.sf % 10), '\0', '\0'};
+    if (profile.sf >= 10)
+    {
+      sf[2] = '1';
+      sf[3] = '0' + profile.sf - 10;
+    }
+    if (sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_SF).arg(sf)))
+    {
+      _radio.sf = profile.sf;
+      _radioKnown |= RADIO_KNOWN_SF;
+    }
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_PRLEN, _radio.preamble == profile.preamble) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_PRLEN).arg(profile.preamble)))
+  {
+    _radio.preamble = profile.preamble;
+    _radioKnown |= RADIO_KNOWN_PRLEN;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_CRC, _radio.crc == profile.crc) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_CRC).argOnOff(profile.crc)))
+  {
+    _radio.crc = profile.crc;
+    _radioKnown |= RADIO_KNOWN_CRC;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_IQI, _radio.iqInvert == profile.iqInvert) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_IQI).argOnOff(profile.iqInvert)))
+  {
+    _radio.iqInvert = profile.iqInvert;
+    _radioKnown |= RADIO_KNOWN_IQI;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_CR, _radio.cr == profile.cr))
+  {
+    char cr[4] = {'4', '/', (char)('4' + profile.cr), '\0'};
+    if (sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_CR).arg(cr)))
+    {
+      _radio.cr = profile.cr;
+      _radioKnown |= RADIO_KNOWN_CR;
+    }
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_SYNC, _radio.sync == profile.sync) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_SYNC).argHex(&profile.sync, 1)))
+  {
+    _radio.sync = profile.sync;
+    _radioKnown |= RADIO_KNOWN_SYNC;
+  }
+
+  if (!radioCacheHit(RADIO_KNOWN_BW, _radio.bw == profile.bw) &&
+      sendCommandOk(rn2xx3_command(rn2xx3_command::RADIO_SET_BW).arg(profile.bw)))
+  {
+    _radio.bw = profile.bw;
+    _radioKnown |= RADIO_KNOWN_BW;
+  }
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::listenP2P()
+{
+  RN2XX3_LOG_AT_INFO(LISTENING, 0, 0);
+  bool rearm = _listenRearm;
+  _listenRearm = false;
+  _listenReceived = false;
+  if (_listenState == LISTEN_OFF || _listenState == LISTEN_RESUME)
+  {
+    drainUnsolicited();
+    armListen();
+  }
+
+  // Until a frame or the watchdog ends the receive window
+  poll();
+  while (_listenState != LISTEN_OFF)
+  {
+    yield();
+    poll();
+  }
+
+  _listenRearm = rearm;
+  if (rearm && _radio2radio)
+    resumeListen(0);
+  return _listenReceived ? TX_WITH_RX : RADIO_LISTEN_WITHOUT_RX;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::startListenP2P(rn2xx3_p2p_callback_t callback)
+{
+  if (!_radio2radio)
+    return false;
+
+  _p2pCallback = callback;
+  _listenRearm = true;
+  if (_listenState == LISTEN_OFF)
+  {
+    drainUnsolicited();
+    armListen();
+  }
+  return true;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::stopListenP2P()
+{
+  _listenRearm = false;
+  pauseListen();
+  _listenState = LISTEN_OFF;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::listeningP2P()
+{
+  return _listenState != LISTEN_OFF;
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::readFramesP2P(uint8_t *buffer, uint16_t size, rn2xx3_frame_info *info, uint8_t max)
+{
+#if RN2XX3_FRAME_RING_BYTES > 0
+  return _frames.pop(buffer, size, info, max);
+#else
+  (void)buffer;
+  (void)size;
+  (void)info;
+  (void)max;
+  return 0;
+#endif
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::getAvailableFramesP2P()
+{
+#if RN2XX3_FRAME_RING_BYTES > 0
+  return _frames.count();
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getDroppedFramesP2P()
+{
+#if RN2XX3_FRAME_RING_BYTES > 0
+  return _frames.dropped();
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getOverflowedFramesP2P()
+{
+#if RN2XX3_FRAME_RING_BYTES > 0
+  return _frames.overflowed();
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::armListen()
+{
+  if (!_radio2radio)
+  {
+    _listenState = LISTEN_OFF;
+    return;
+  }
+
+  // Receive until a frame arrives or the watchdog timer expires
+  rn2xx3_command command(rn2xx3_command::RADIO_RX);
+  command.arg(0);
+  writeLine(NULL, command.c_str(), command.length());
+  _listenState = LISTEN_ARMING;
+  _listenDeadline = millis() + 2000;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::resumeListen(unsigned long waitMs)
+{
+  _listenState = LISTEN_RESUME;
+  _listenDeadline = millis() + waitMs;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::pauseListen()
+{
+  if (_listenState == LISTEN_ARMING || _listenState == LISTEN_SNR)
+  {
+    // The reply to "radio rx" or "radio get snr" is still on its way
+    handleUnsolicited(_reader.read(_serial, 2000));
+    _reader.clear();
+    if (_listenState == LISTEN_SNR)
+      endListenWindow();
+  }
+
+  if (_listenState == LISTEN_ARMING || _listenState == LISTEN_ACTIVE)
+  {
+    // Resume first, so the command below does not try to pause again
+    resumeListen(0);
+    sendCommand(rn2xx3_command::RADIO_RXSTOP);
+  }
+
+  if (!_radio2radio)
+    _listenState = LISTEN_OFF;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::endListenWindow()
+{
+  if (_listenState != LISTEN_ARMING && _listenState != LISTEN_ACTIVE && _listenState != LISTEN_SNR)
+    return;
+  if (_listenRearm)
+    resumeListen(0);
+  else
+    _listenState = LISTEN_OFF;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::handleListenLine(const rn2xx3_line &receivedData)
+{
+  rn2xx3_reply reply;
+  reply.parse(receivedData.data, receivedData.length);
+  if (_listenState == LISTEN_SNR && !isTxResult(reply.type))
+  {
+    // The reply to "radio get snr", for the frame just stored
+#if RN2XX3_FRAME_RING_BYTES > 0
+    if (reply.type == rn2xx3_reply::UNKNOWN)
+      _frames.setSnr(receivedData.toInt());
+#endif
+    endListenWindow();
+    return true;
+  }
+
+  switch (reply.type)
+  {
+  case rn2xx3_reply::ok:
+    if (_listenState != LISTEN_ARMING)
+      return false;
+    _listenState = LISTEN_ACTIVE;
+    return true;
+
+  case rn2xx3_reply::busy:
+    if (_listenState != LISTEN_ARMING)
+      return false;
+    resumeListen(100);
+    return true;
+
+  case rn2xx3_reply::invalid_param:
+    if (_listenState != LISTEN_ARMING)
+      return false;
+    _listenState = LISTEN_OFF;
+    return true;
+
+  case rn2xx3_reply::radio_rx:
+    //example: radio_rx  54657374696E6720313233
+    _listenReceived = true;
+    if (!storeRx(0, receivedData.substring(reply.payloadOffset)))
+    {
+#if RN2XX3_FRAME_RING_BYTES > 0
+      _frames.countOverflow();
+#endif
+      endListenWindow();
+    }
+#if RN2XX3_FRAME_RING_BYTES > 0
+    else if (_frames.push(_rxBytes, _rxLength, millis()) &&
+             (_listenState == LISTEN_ARMING || _listenState == LISTEN_ACTIVE))
+    {
+      // The SNR only describes this frame until the next one arrives
+      writeLine(rn2xx3_command::text(rn2xx3_command::RADIO_GET_SNR), NULL, 0);
+      _listenState = LISTEN_SNR;
+      _listenDeadline = millis() + 2000;
+    }
+#endif
+    else
+    {
+      endListenWindow();
+    }
+    if (_p2pCallback)
+      _p2pCallback(_rxBytes, _rxLength);
+    return true;
+
+  case rn2xx3_reply::radio_err:
+    // The watchdog timer ended the receive window
+    endListenWindow();
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::initOTAA(const String &AppEUI, const String &AppKey, const String &DevEUI)
+{
+  _otaa = true;
+  _radio2radio = false;
+  _nwkskey = "0";
+  _commandTooLong = false;
+  rn2xx3_line receivedData;
+
+  //handle what is left in the serial buffer
+  drainUnsolicited();
+
+  // detect which model radio we are using
+  configureModuleType();
+
+  // After a reboot of only the MCU the RN2xx3 is often still joined
+  if (_sessionResume && resumeOTAA(AppEUI, DevEUI))
+  {
+    _deveui = DevEUI.length() == 16 ? DevEUI : hweui();
+    if (AppEUI.length() == 16)
+      _appeui = AppEUI;
+    if (AppKey.length() == 32)
+      _appskey = AppKey;
+    return true;
+  }
+
+  // reset the module - this will clear all keys set previously
+  switch (_moduleType)
+  {
+  case RN2903:
+    sendCommand(rn2xx3_command::MAC_RESET);
+    invalidateCache();
+    break;
+  case RN2483:
+    sendCommand(rn2xx3_command(rn2xx3_command::MAC_RESET_BAND).arg(868));
+    invalidateCache();
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+    _dutyCycle.reset();
+#endif
+    break;
+  default:
+    // we shouldn't go forward with the init
+    return false;
+  }
+
+  // If the Device EUI was given as a parameter, use it
+  // otherwise use the Hardware EUI.
+  if (DevEUI.length() == 16)
+  {
+    _deveui = DevEUI;
+  }
+  else
+  {
+    String addr = hweui();
+    if (addr.length() == 16)
+    {
+      _deveui = addr;
+    }
+    // else fall back to the hard coded value in the header file
+  }
+
+  beginBatch();
+  sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_DEVEUI).arg(_deveui));
+
+  // A valid length App EUI was given. Use it.
+  if (AppEUI.length() == 16)
+  {
+    _appeui = AppEUI;
+    sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_APPEUI).arg(_appeui));
+  }
+
+  // A valid length App Key was give. Use it.
+  if (AppKey.length() == 32)
+  {
+    _appskey = AppKey; //reuse the same variable as for ABP
+    sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_APPKEY).arg(_appskey));
+  }
+
+  if (_moduleType == RN2903)
+  {
+    setTXoutputPower(5);
+  }
+  else
+  {
+    setTXoutputPower(1);
+  }
+
+  // TTN does not yet support Adaptive Data Rate.
+  // Using it is also only necessary in limited situations.
+  // Therefore disable it by default.
+  setAdaptiveDataRate(false);
+
+  // Automatic replies are off unless asked for. See RN2483 datasheet,
+  // 2.4.8.14, page 27 and the scenario on page 19.
+  setAutomaticReply(_automaticReply);
+  applyLinkCheck();
+  endBatch();
+
+  // Not joined with a truncated EUI or key
+  if (_commandTooLong)
+    return false;
+
+  // Semtech and TTN both use a non default RX2 window freq and SF.
+  // Maybe we should not specify this for other networks.
+  // if (_moduleType == RN2483)
+  // {
+  //   set2ndRecvWindow(3, 869525000);
+  // }
+  // Disabled for now because an OTAA join seems to work fine without.
+
+  sendCommand(rn2xx3_command::MAC_SAVE, 30000);
+
+  bool joined = false;
+
+  // Only try twice to join, then return and let the user handle it.
+  for (int i = 0; i < 2 && !joined; i++)
+  {
+    sendCommand(rn2xx3_command::MAC_JOIN_OTAA, 30000);
+    // Parse 2nd response
+    receivedData = _reader.read(_serial, 30000);
+    // The join accept can carry a channel list and RX settings
+    invalidateNetworkControlled(true);
+
+    if (determineReceivedDataType(receivedData) == rn2xx3_reply::accepted)
+    {
+      joined = true;
+      delay(1000);
+    }
+    else
+    {
+      delay(1000);
+    }
+  }
+  return joined;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::initOTAA(uint8_t *AppEUI, uint8_t *AppKey, uint8_t *DevEUI)
+{
+  _radio2radio = false;
+  char app_eui[17];
+  char dev_eui[17] = "0";
+  char app_key[33];
+
+  rn2xx3_hex::encode(app_eui, AppEUI, 8);
+  app_eui[16] = '\0';
+
+  if (DevEUI) //==0
+  {
+    rn2xx3_hex::encode(dev_eui, DevEUI, 8);
+    dev_eui[16] = '\0';
+  }
+
+  rn2xx3_hex::encode(app_key, AppKey, 16);
+  app_key[32] = '\0';
+
+  return initOTAA(String(app_eui), String(app_key), String(dev_eui));
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::initABP(const String &devAddr, const String &AppSKey, const String &NwkSKey)
+{
+  _radio2radio = false;
+  _otaa = false;
+  _devAddr = devAddr;
+  _appskey = AppSKey;
+  _nwkskey = NwkSKey;
+  _commandTooLong = false;
+  rn2xx3_line receivedData;
+
+  //handle what is left in the serial buffer
+  drainUnsolicited();
+
+  configureModuleType();
+
+  // After a reboot the RN2xx3 can continue the saved session
+  if (_sessionResume && resumeABP(_devAddr))
+  {
+    return true;
+  }
+
+  switch (_moduleType)
+  {
+  case RN2903:
+    sendCommand(rn2xx3_command::MAC_RESET);
+    invalidateCache();
+    break;
+  case RN2483:
+    sendCommand(rn2xx3_command(rn2xx3_command::MAC_RESET_BAND).arg(868));
+    invalidateCache();
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+    _dutyCycle.reset();
+#endif
+    // set2ndRecvWindow(3, 869525000);
+    // In the past we set the downlink channel here,
+    // but setFrequencyPlan is a better place to do it.
+    break;
+  default:
+    // we shouldn't go forward with the init
+    return false;
+  }
+
+  beginBatch();
+  sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_NWKSKEY).arg(_nwkskey));
+  sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_APPSKEY).arg(_appskey));
+  sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_DEVADDR).arg(_devAddr));
+  setAdaptiveDataRate(false);
+
+  // Automatic replies are off unless asked for. See RN2483 datasheet,
+  // 2.4.8.14, page 27 and the scenario on page 19.
+  setAutomaticReply(_automaticReply);
+  applyLinkCheck();
+
+  if (_moduleType == RN2903)
+  {
+    setTXoutputPower(5);
+  }
+  else
+  {
+    setTXoutputPower(1);
+  }
+  setDR(initialDataRate()); //0= min, 7=max
+  endBatch();
+
+  // Not joined with a truncated address or key
+  if (_commandTooLong)
+    return false;
+
+  sendCommand(rn2xx3_command::MAC_SAVE, 60000);
+  sendCommand(rn2xx3_command::MAC_JOIN_ABP, 60000);
+  receivedData = _reader.read(_serial, 60000);
+
+  delay(1000);
+
+  if (determineReceivedDataType(receivedData) == rn2xx3_reply::accepted)
+  {
+    return true;
+    //with abp we can always join successfully as long as the keys are valid
+  }
+  else
+  {
+    return false;
+  }
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::tx(const String &data)
+{
+  return txUncnf(data); //we are unsure which mode we're in. Better not to wait for acks.
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::txBytes(const byte *data, uint8_t size)
+{
+  if (_radio2radio)
+    return txCommand(rn2xx3_command::RADIO_TX, data, size); /* p2p tx command */
+  else
+    return txCommand(rn2xx3_command::MAC_TX_UNCNF, data, size); /* LoraWan tx command */
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::txCnf(const String &data)
+{
+  const uint8_t *bytes = (const uint8_t *)data.c_str();
+  if (_radio2radio)
+    return txCommand(rn2xx3_command::RADIO_TX, bytes, data.length()); /* p2p tx command */
+  else
+    return txCommand(rn2xx3_command::MAC_TX_CNF, bytes, data.length()); /* LoraWan tx command */
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::txUncnf(const String &data)
+{
+  const uint8_t *bytes = (const uint8_t *)data.c_str();
+  if (_radio2radio)
+    return txCommand(rn2xx3_command::RADIO_TX, bytes, data.length()); /* p2p tx command */
+  else
+    return txCommand(rn2xx3_command::MAC_TX_UNCNF, bytes, data.length()); /* LoraWan tx command */
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::beginTx(const String &data, bool confirmed)
+{
+  if (_txState != TX_IDLE)
+    return false;
+
+  // The caller's String may be a temporary, so keep a copy while pending
+  prepareTx();
+  _txText = data;
+  const uint8_t *bytes = (const uint8_t *)_txText.c_str();
+  if (_radio2radio)
+    return startTx(rn2xx3_command::RADIO_TX, bytes, _txText.length()); /* p2p tx command */
+  else if (confirmed)
+    return startTx(rn2xx3_command::MAC_TX_CNF, bytes, _txText.length()); /* LoraWan tx command */
+  else
+    return startTx(rn2xx3_command::MAC_TX_UNCNF, bytes, _txText.length());
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::beginTxBytes(const byte *data, uint8_t size, bool confirmed)
+{
+  prepareTx();
+  if (_radio2radio)
+    return startTx(rn2xx3_command::RADIO_TX, data, size); /* p2p tx command */
+  else if (confirmed)
+    return startTx(rn2xx3_command::MAC_TX_CNF, data, size); /* LoraWan tx command */
+  else
+    return startTx(rn2xx3_command::MAC_TX_UNCNF, data, size);
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::txPending()
+{
+  return _txState != TX_IDLE;
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::txResult()
+{
+  return _txResult;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::onTxDone(rn2xx3_tx_callback_t callback)
+{
+  _txCallback = callback;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::queueUplink(const byte *data, uint8_t size, UPLINK_PRIORITY priority, unsigned long maxDelayMs)
+{
+#if RN2XX3_QUEUE_BYTES > 0
+  return _uplinks.push(data, size, priority, millis() + maxDelayMs);
+#else
+  (void)data;
+  (void)size;
+  (void)priority;
+  (void)maxDelayMs;
+  return false;
+#endif
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::sendQueuedUplinks()
+{
+  prepareTx();
+  return startQueuedUplink(true);
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::getQueuedUplinks()
+{
+#if RN2XX3_QUEUE_BYTES > 0
+  return _uplinks.count();
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getDroppedUplinks()
+{
+#if RN2XX3_QUEUE_BYTES > 0
+  return _uplinksDropped;
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::startQueuedUplink(bool force)
+{
+#if RN2XX3_QUEUE_BYTES > 0
+  if (_txState != TX_IDLE || _uplinks.count() == 0 || _uplinks.sending() || _rejoin != REJOIN_NONE)
+    return false;
+
+  // While the duty cycle holds the uplink back, more messages can join it
+  unsigned long now = millis();
+  if ((long)(nextTxAllowedAt() - now) > 0)
+    return false;
+
+  uint16_t capacity = RN2XX3_QUEUE_BYTES;
+  if (!_radio2radio)
+    capacity = rn2xx3_airtime::maxPayload(_moduleType == RN2903, knownDataRate());
+  if (!force && !_uplinks.due(now, capacity))
+    return false;
+
+  // A message too large for the slowest data rate may still fit the actual
+  // one, so it waits until the data rate is known
+  if (_radio2radio || _shadow.dr >= 0)
+    _uplinksDropped += _uplinks.dropLarger(capacity);
+  uint16_t length = _uplinks.prepareFrame(capacity);
+  if (length == 0)
+    return false;
+
+  return startTx(_radio2radio ? rn2xx3_command::RADIO_TX : rn2xx3_command::MAC_TX_UNCNF, _uplinks.frame(), length);
+#else
+  (void)force;
+  return false;
+#endif
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::txCommand(rn2xx3_command::id_t command, const uint8_t *data, uint16_t length)
+{
+#if RN2XX3_QUEUE_BYTES > 0
+  // A frame from the uplink queue has to complete first
+  while (_uplinks.sending() && poll())
+    yield();
+#endif
+
+  // A reply to an earlier uplink may have asked for a rejoin
+  if (_rejoin != REJOIN_NONE && !rejoin())
+    return TX_FAIL;
+
+  prepareTx();
+  if (!startTx(command, data, length))
+    return TX_FAIL;
+  _txBlocking = true;
+  TX_RETURN_TYPE result = waitTx();
+  _txBlocking = false;
+  return result;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::prepareTx()
+{
+  if (_txState != TX_IDLE || _radio2radio)
+    return;
+  if (_dataRateControl)
+    updateDataRate();
+  currentDataRate();
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::startTx(rn2xx3_command::id_t command, const uint8_t *data, uint16_t length)
+{
+  if (_txState != TX_IDLE)
+    return false;
+
+  _txCommand = command;
+  _txData = data;
+  _txLength = length;
+  if (command != rn2xx3_command::RADIO_TX && _dataRateControl)
+    _txLinkCheck = _linkCheckS > 0 && (long)(millis() - _linkCheckDue) >= 0;
+  if (command != rn2xx3_command::RADIO_TX)
+  {
+    // For the duty cycle ledger and the link measurements
+    _txDataRate = knownDataRate();
+  }
+  _txRetryCount = 0;
+  _txBusyCount = 0;
+
+  //handle what is left in the serial buffer
+  drainUnsolicited();
+
+  sendTxAttempt();
+  return true;
+}
+
+template <class Transport>
+TX_RETURN_TYPE rn2xx3_t<Transport>::waitTx()
+{
+  while (poll())
+  {
+    if (_txState == TX_REJOIN)
+    {
+      // Sent again as the next attempt, so the retry limit still holds
+      rejoin();
+      retryTx(0);
+    }
+    yield();
+  }
+  return _txResult;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::poll()
+{
+  switch (_txState)
+  {
+  case TX_IDLE:
+    while (_pipeCount == 0 && _reader.poll(_serial))
+      handleUnsolicited(_reader.line());
+    if (_pipeCount == 0 && _listenState != LISTEN_OFF && _listenState != LISTEN_ACTIVE &&
+        (long)(millis() - _listenDeadline) >= 0)
+    {
+      // A lost reply to "radio rx" most likely was an "ok"
+      if (_listenState == LISTEN_RESUME)
+        armListen();
+      else if (_listenState == LISTEN_ARMING)
+        _listenState = LISTEN_ACTIVE;
+      else
+        endListenWindow();
+    }
+    if (_pipeCount > 0)
+      return false;
+    if (startQueuedUplink(false))
+      return true;
+#if RN2XX3_LOG_LEVEL > RN2XX3_LOG_NONE
+    // Nothing is waiting for the RN2xx3, so a slow debug port does no harm
+    if (_logOutput)
+      flushLog(*_logOutput, 1);
+#endif
+    return false;
+
+  case TX_RETRY:
+    if ((long)(millis() - _txDeadline) >= 0)
+    {
+      sendTxAttempt();
+    }
+    break;
+
+  case TX_REJOIN:
+    break;
+
+  case TX_WAIT_REPLY:
+  case TX_WAIT_RESULT:
+    if (_reader.poll(_serial))
+    {
+      RN2XX3_LOG_AT_DEBUG(RECEIVED, determineReceivedDataType(_reader.line()), _reader.line().length);
+    }
+    else if ((long)(millis() - _txDeadline) >= 0)
+    {
+      // Same as a timed out read: handle an empty response
+      _reader.clear();
+    }
+    else
+    {
+      break;
+    }
+
+    if (_txState == TX_WAIT_REPLY)
+      handleTxReply(_reader.line());
+    else
+      handleTxResult(_reader.line());
+    _reader.clear();
+    break;
+  }
+
+  return _txState != TX_IDLE;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::sendTxAttempt()
+{
+  //retransmit a maximum of 10 times
+  _txRetryCount++;
+  if (_txRetryCount > 10)
+  {
+    finishTx(TX_FAIL);
+    return;
+  }
+  if (_txRetryCount > 1)
+    RN2XX3_STATS_DO(_stats.retries++);
+
+  RN2XX3_LOG_AT_DEBUG(TX_SENT, _txRetryCount, _txLength);
+  _serial.print(rn2xx3_command::text(_txCommand));
+  rn2xx3_hex::print(_serial, _txData, _txLength);
+  _serial.println();
+  countWrite(strlen_P(reinterpret_cast<PGM_P>(rn2xx3_command::text(_txCommand))) + 2 * _txLength + 2);
+  RN2XX3_STATS_DO(_txSentAt = millis());
+
+  _txState = TX_WAIT_REPLY;
+  _txDeadline = millis() + 2000;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::retryTx(unsigned long waitMs)
+{
+  _txState = TX_RETRY;
+  _txDeadline = millis() + waitMs;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::finishTx(TX_RETURN_TYPE result)
+{
+  if (!_radio2radio)
+  {
+    // The network may have changed settings using MAC commands in the downlink.
+    // Without ADR it does not touch the data rate and output power.
+    invalidateNetworkControlled(_shadow.adr != 0);
+
+    if (_dataRateControl)
+    {
+      // Read by updateDataRate() before the next uplink the application
+      // starts, as poll() must not wait for the RN2xx3
+      _linkDataRate = _txDataRate;
+      if (_txLinkCheck && result != TX_FAIL)
+      {
+        _linkPending |= LINK_CHECK;
+        _linkCheckDue = millis() + _linkCheckS * 1000UL;
+      }
+      if (result == TX_WITH_RX)
+        _linkPending |= LINK_SNR;
+      _txLinkCheck = false;
+    }
+  }
+
+#if RN2XX3_QUEUE_BYTES > 0
+  if (_uplinks.sending())
+  {
+    uint8_t messages = _uplinks.completeFrame();
+    if (result == TX_FAIL)
+      _uplinksDropped += messages;
+  }
+#endif
+
+  _txState = TX_IDLE;
+  _txResult = result;
+  if (_txCallback)
+    _txCallback(result);
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::rejoinTx(rejoin_t rejoin)
+{
+  if (rejoin > _rejoin)
+    _rejoin = rejoin;
+  if (_txBlocking)
+    _txState = TX_REJOIN;
+  else
+    finishTx(TX_FAIL);
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::rejoinNeeded()
+{
+  return _rejoin != REJOIN_NONE;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::rejoin()
+{
+  if (_rejoin == REJOIN_NONE)
+    return true;
+  if (_txState != TX_IDLE && _txState != TX_REJOIN)
+    return false;
+
+  RN2XX3_STATS_DO(_stats.rejoins++);
+  bool forced = _rejoin == REJOIN_FORCED;
+  _rejoin = REJOIN_NONE;
+  return forced ? forceInit() : init();
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::handleTxReply(const rn2xx3_line &receivedData)
+{
+  rn2xx3_reply reply;
+  received_t type = reply.parse(receivedData.data, receivedData.length);
+  countReply(type);
+  switch (type)
+  {
+  case rn2xx3_reply::ok:
+  {
+    RN2XX3_STATS_DO(_txOkAt = millis());
+    RN2XX3_STATS_DO(rn2xx3_stats::record(_stats.commandLatency, _txOkAt - _txSentAt));
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+    if (_txCommand != rn2xx3_command::RADIO_TX && _moduleType == RN2483)
+    {
+      _dutyCycle.recordUplink(millis(), rn2xx3_airtime::lorawan(false, _txDataRate, _txLength));
+    }
+#endif
+
+    // The result only arrives after the RX windows
+    _txState = TX_WAIT_RESULT;
+    _txDeadline = millis() + 30000;
+    break;
+  }
+
+  case rn2xx3_reply::radio_rx:
+  {
+    //SUCCESS!!
+    storeRx(0, receivedData.substring(reply.payloadOffset));
+    finishTx(TX_WITH_RX);
+    break;
+  }
+
+  case rn2xx3_reply::mac_rx:
+  case rn2xx3_reply::mac_tx_ok:
+  case rn2xx3_reply::mac_err:
+  {
+    // The end of an automatic reply the module sent after the previous
+    // uplink. Keep waiting for the reply to this one.
+    handleUnsolicited(receivedData);
+    break;
+  }
+
+  case rn2xx3_reply::invalid_param:
+  {
+    //should not happen if we typed the commands correctly
+    finishTx(TX_FAIL);
+    break;
+  }
+
+  case rn2xx3_reply::not_joined:
+  {
+    rejoinTx(REJOIN_INIT);
+    break;
+  }
+
+  case rn2xx3_reply::no_free_ch:
+  {
+    // Retry once the duty cycle opens a channel. If the ledger expected
+    // a free channel already it is behind the module, so check every second.
+    long wait = (long)(nextTxAllowedAt() - millis());
+    retryTx(wait > 0 ? wait : 1000);
+    break;
+  }
+
+  case rn2xx3_reply::silent:
+  {
+    rejoinTx(REJOIN_FORCED);
+    break;
+  }
+
+  case rn2xx3_reply::frame_counter_err_rejoin_needed:
+  {
+    rejoinTx(REJOIN_FORCED);
+    break;
+  }
+
+  case rn2xx3_reply::busy:
+  {
+    _txBusyCount++;
+
+    // Not sure if this is wise. At low data rates with large packets
+    // this can perhaps cause transmissions at more than 1% duty cycle.
+    // Need to calculate the correct constant value.
+    // But it is wise to have this check and re-init in case the
+    // lorawan stack in the RN2xx3 hangs.
+    if (_txBusyCount >= 10)
+    {
+      rejoinTx(REJOIN_FORCED);
+    }
+    else
+    {
+      retryTx(1000);
+    }
+    break;
+  }
+
+  case rn2xx3_reply::mac_paused:
+  {
+    rejoinTx(REJOIN_INIT);
+    break;
+  }
+
+  case rn2xx3_reply::invalid_data_len:
+  {
+    //should not happen if the prototype worked
+    finishTx(TX_FAIL);
+    break;
+  }
+
+  default:
+  {
+    //unknown response after mac tx command
+    rejoinTx(REJOIN_FORCED);
+    break;
+  }
+  }
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::handleTxResult(const rn2xx3_line &receivedData)
+{
+  rn2xx3_reply reply;
+  received_t type = reply.parse(receivedData.data, receivedData.length);
+  countReply(type);
+  RN2XX3_LOG_AT_INFO(TX_RESULT, type, receivedData.length);
+  if (isTxResult(type))
+    RN2XX3_STATS_DO(rn2xx3_stats::record(_stats.txLatency, millis() - _txOkAt));
+  switch (type)
+  {
+  case rn2xx3_reply::mac_tx_ok:
+  {
+    //SUCCESS!!
+    finishTx(TX_SUCCESS);
+    break;
+  }
+
+  case rn2xx3_reply::mac_rx:
+  {
+    //example: mac_rx 1 54657374696E6720313233
+    // With automatic replies more can follow, which arrive unsolicited.
+    bool stored = storeRx(reply.port, receivedData.substring(reply.payloadOffset));
+    finishTx(TX_WITH_RX);
+    if (stored)
+      dispatchDownlink();
+    break;
+  }
+
+  case rn2xx3_reply::mac_err:
+  {
+    rejoinTx(REJOIN_FORCED);
+    break;
+  }
+
+  case rn2xx3_reply::invalid_data_len:
+  {
+    //this should never happen if the prototype worked
+    RN2XX3_LOG_AT_ERROR(TX_ERROR, type, 0);
+    finishTx(TX_FAIL);
+    break;
+  }
+
+  case rn2xx3_reply::radio_tx_ok:
+  {
+    //SUCCESS!!
+    finishTx(TX_SUCCESS);
+    break;
+  }
+
+  case rn2xx3_reply::radio_rx:
+  {
+    //SUCCESS!!
+    storeRx(0, receivedData.substring(reply.payloadOffset));
+    finishTx(TX_WITH_RX);
+    break;
+  }
+
+  case rn2xx3_reply::radio_err:
+  {
+    //This should never happen. If it does, something major is wrong.
+    RN2XX3_LOG_AT_ERROR(TX_ERROR, type, 0);
+    rejoinTx(REJOIN_FORCED);
+    break;
+  }
+
+  default:
+  {
+    //unknown response
+    //init();
+    retryTx(0);
+  }
+  }
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::storeRx(uint8_t port, const rn2xx3_line &payload)
+{
+  _rxPort = port;
+  if (_reader.overflowed())
+  {
+    // Part of the payload is missing
+    _rxLength = 0;
+    RN2XX3_STATS_DO(_stats.longDownlinks++);
+    return false;
+  }
+
+  uint16_t length = payload.length / 2;
+  if (length > sizeof(_rxBytes))
+    length = sizeof(_rxBytes);
+  _rxLength = rn2xx3_hex::decode(_rxBytes, payload.data, length * 2) ? length : 0;
+  return true;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::dispatchDownlink()
+{
+  rn2xx3_downlink_handler_t handler = NULL;
+  for (uint8_t i = 0; i < RN2XX3_DOWNLINK_HANDLERS; i++)
+  {
+    if (!_downlinkHandlers[i])
+      continue;
+    if (_downlinkPorts[i] == _rxPort)
+    {
+      handler = _downlinkHandlers[i];
+      break;
+    }
+    if (_downlinkPorts[i] == 0)
+      handler = _downlinkHandlers[i];
+  }
+  if (handler)
+    handler(_rxPort, _rxBytes, _rxLength);
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::onDownlink(uint8_t port, rn2xx3_downlink_handler_t handler)
+{
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < RN2XX3_DOWNLINK_HANDLERS; i++)
+  {
+    if (_downlinkHandlers[i] && _downlinkPorts[i] == port)
+    {
+      slot = i;
+      break;
+    }
+    if (!_downlinkHandlers[i] && slot < 0)
+      slot = i;
+  }
+  if (slot < 0)
+    return handler == NULL;
+
+  _downlinkPorts[slot] = port;
+  _downlinkHandlers[slot] = handler;
+  return true;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::base16encode(const String &input_c)
+{
+  String input(input_c); // Make a deep copy to be able to do trim()
+  input.trim();
+  // Stop at an embedded NUL, like the String functions would
+  const size_t inputLength = strlen(input.c_str());
+  String output;
+  output.reserve(inputLength * 2);
+
+  char chunk[33];
+  for (size_t i = 0; i < inputLength; i += 16)
+  {
+    size_t bytes = inputLength - i < 16 ? inputLength - i : 16;
+    rn2xx3_hex::encode(chunk, (const uint8_t *)input.c_str() + i, bytes, true);
+    chunk[bytes * 2] = '\0';
+    output += chunk;
+  }
+  return output;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::getRx()
+{
+  String output;
+  output.reserve(_rxLength * 2);
+
+  char chunk[33];
+  for (uint16_t i = 0; i < _rxLength; i += 16)
+  {
+    uint16_t bytes = _rxLength - i < 16 ? _rxLength - i : 16;
+    rn2xx3_hex::encode(chunk, _rxBytes + i, bytes);
+    chunk[bytes * 2] = '\0';
+    output += chunk;
+  }
+  return output;
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::getRxPort()
+{
+  return _rxPort;
+}
+
+template <class Transport>
+const uint8_t *rn2xx3_t<Transport>::getRxBytes()
+{
+  return _rxBytes;
+}
+
+template <class Transport>
+uint16_t rn2xx3_t<Transport>::getRxLength()
+{
+  return _rxLength;
+}
+
+template <class Transport>
+int rn2xx3_t<Transport>::getSNR()
+{
+  return readIntValue(rn2xx3_command::RADIO_GET_SNR);
+}
+
+template <class Transport>
+int rn2xx3_t<Transport>::getVbat()
+{
+  return readIntValue(rn2xx3_command::SYS_GET_VDD);
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::base16decode(const String &input_c)
+{
+  String input(input_c); // Make a deep copy to be able to do trim()
+  input.trim();
+  const size_t inputLength = input.length();
+  String output;
+  output.reserve(inputLength / 2);
+
+  uint8_t chunk[17];
+  for (size_t i = 0; i < inputLength; i += 32)
+  {
+    size_t digits = inputLength - i < 32 ? inputLength - i : 32;
+    if (!rn2xx3_hex::decode(chunk, input.c_str() + i, digits))
+      return String();
+    // A String can not hold NUL characters, leave them out
+    for (size_t j = 0; j < digits / 2; j++)
+    {
+      if (chunk[j] != 0)
+        output += (char)chunk[j];
+    }
+  }
+  return output;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::setDR(int dr)
+{
+  if (dr >= 0 && dr <= 5)
+  {
+    if (cacheHit(_shadow.dr == dr))
+      return;
+    if (sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_DR).arg(dr)))
+      _shadow.dr = dr;
+  }
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::enableDataRateControl(uint8_t targetMargin, uint16_t linkCheckS, uint8_t minDr, uint8_t maxDr)
+{
+  _dataRate.configure(_moduleType == RN2903, minDr, maxDr, targetMargin);
+  _dataRateControl = true;
+  _linkCheckS = linkCheckS;
+  _linkCheckDue = millis();
+
+  beginBatch();
+  setAdaptiveDataRate(false);
+  applyLinkCheck();
+  return endBatch() == 0;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::disableDataRateControl()
+{
+  _dataRateControl = false;
+  _linkCheckS = 0;
+  _linkPending = 0;
+  _dataRate.reset();
+  sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_LINKCHK).arg(0));
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::applyLinkCheck()
+{
+  if (!_dataRateControl)
+    return true;
+  return sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_LINKCHK).arg(_linkCheckS));
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::initialDataRate()
+{
+  return _dataRateControl ? _dataRate.choose(5) : 5;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::updateDataRate()
+{
+  if (_linkPending & LINK_CHECK)
+  {
+    // The answer to the link check came with the uplink
+    int gateways = readIntValue(rn2xx3_command::MAC_GET_GWNB);
+    if (gateways > 0)
+      _dataRate.addMargin(_linkDataRate, readIntValue(rn2xx3_command::MAC_GET_MRGN));
+    else
+      _dataRate.addLoss();
+  }
+  if (_linkPending & LINK_SNR)
+  {
+    // Only some firmware answers while the MAC is running
+    rn2xx3_line snr = sendCommand(rn2xx3_command::RADIO_GET_SNR);
+    if (snr.length > 0 && determineReceivedDataType(snr) == rn2xx3_reply::UNKNOWN)
+      _dataRate.addSnr(snr.toInt());
+  }
+  _linkPending = 0;
+
+  setDR(_dataRate.choose(currentDataRate()));
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::sleep(long msec)
+{
+  if (_listenState != LISTEN_OFF)
+    stopListenP2P();
+  drainUnsolicited();
+
+  _serial.print(rn2xx3_command::text(rn2xx3_command::SYS_SLEEP));
+  size_t written = _serial.println(msec);
+  countWrite(strlen_P(reinterpret_cast<PGM_P>(rn2xx3_command::text(rn2xx3_command::SYS_SLEEP))) + written);
+
+  _sleeping = true;
+  _wakeSeen = false;
+  _sleepUntil = millis() + msec;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::wake()
+{
+  if (!_sleeping)
+    return true;
+  _sleeping = false;
+  unsigned long start = micros();
+
+  bool early = (long)(millis() - _sleepUntil) < 0;
+  if (early)
+  {
+    // A break wakes the RN2xx3 before its time, 0x55 syncs the baud rate
+    _serial.write((byte)0x00);
+    _serial.write(0x55);
+    RN2XX3_STATS_DO(_stats.bytesWritten += 2);
+  }
+
+  // The RN2xx3 says "ok" once it is awake
+  unsigned long waitStart = millis();
+  while (!_wakeSeen && millis() - waitStart < 100)
+  {
+    rn2xx3_line line = _reader.read(_serial, 100 - (millis() - waitStart));
+    if (line.equals(F("ok")))
+      _wakeSeen = true;
+    else
+      handleUnsolicited(line);
+  }
+
+  // One short command shows whether the link still works; only if it
+  // does not, a full autobaud follows
+  bool ready = sendCommand(rn2xx3_command::SYS_GET_VDD, 200).toInt() > 0 || autobaud();
+
+  _lastWakeLatency = micros() - start;
+  return ready;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::sleeping()
+{
+  return _sleeping;
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getLastWakeLatency()
+{
+  return _lastWakeLatency;
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::sendRawCommand(const String &command)
+{
+  forgetRawCommand(command);
+  String ret = sendCommand(command).c_str();
+  ret.trim();
+  return ret;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::forgetRawCommand(const String &command)
+{
+  // We can not tell what a raw command changes, except when it only reads
+  if (!command.startsWith(F("mac get")) && !command.startsWith(F("sys get")) && !command.startsWith(F("radio get")))
+  {
+    invalidateCache();
+  }
+
+  // The RN2xx3 forgets its channel timers, as after the reset of init
+  if (command.startsWith(F("mac reset")) || command.startsWith(F("sys reset")) ||
+      command.startsWith(F("sys factoryRESET")))
+  {
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+    _dutyCycle.reset();
+#endif
+  }
+}
+
+template <class Transport>
+rn2xx3_line rn2xx3_t<Transport>::sendCommand(rn2xx3_command::id_t command, unsigned long timeoutMs)
+{
+  return sendLine(rn2xx3_command::text(command), NULL, 0, timeoutMs);
+}
+
+template <class Transport>
+rn2xx3_line rn2xx3_t<Transport>::sendCommand(const rn2xx3_command &command, unsigned long timeoutMs)
+{
+  if (command.overflowed())
+  {
+    // Like a command that got no reply
+    refuseCommand();
+    rn2xx3_line none = {"", 0};
+    return none;
+  }
+  return sendLine(NULL, command.c_str(), command.length(), timeoutMs);
+}
+
+template <class Transport>
+rn2xx3_line rn2xx3_t<Transport>::sendCommand(const String &command, unsigned long timeoutMs)
+{
+  return sendLine(NULL, command.c_str(), command.length(), timeoutMs);
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::writeLine(const __FlashStringHelper *command, const char *text, size_t length)
+{
+  if (command)
+  {
+    _serial.println(command);
+    countWrite(strlen_P(reinterpret_cast<PGM_P>(command)) + 2);
+  }
+  else
+  {
+    _serial.write((const uint8_t *)text, length);
+    _serial.println();
+    countWrite(length + 2);
+  }
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::countWrite(size_t bytes)
+{
+#if RN2XX3_STATS
+  _stats.commands++;
+  _stats.bytesWritten += bytes;
+#else
+  (void)bytes;
+#endif
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::countReply(received_t type)
+{
+#if RN2XX3_STATS
+  switch (type)
+  {
+  case rn2xx3_reply::busy:
+    _stats.busy++;
+    break;
+  case rn2xx3_reply::no_free_ch:
+    _stats.noFreeChannel++;
+    break;
+  case rn2xx3_reply::not_joined:
+    _stats.notJoined++;
+    break;
+  case rn2xx3_reply::mac_err:
+    _stats.macErr++;
+    break;
+  default:
+    break;
+  }
+#else
+  (void)type;
+#endif
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::getStats(rn2xx3_stats &stats, bool reset)
+{
+#if RN2XX3_STATS
+  stats = _stats;
+  stats.bytesRead = _reader.bytesRead() - _statsBytesRead;
+  if (reset)
+    resetStats();
+#else
+  (void)reset;
+  stats.reset();
+#endif
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::resetStats()
+{
+#if RN2XX3_STATS
+  _stats.reset();
+  _statsBytesRead = _reader.bytesRead();
+#endif
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::flushLog(Print &out, uint8_t max)
+{
+  uint8_t written = 0;
+#if RN2XX3_LOG_LEVEL > RN2XX3_LOG_NONE
+  rn2xx3_log_record record;
+  while (written < max && _log.pop(record))
+  {
+    rn2xx3_log::print(out, record);
+    written++;
+  }
+#else
+  (void)out;
+  (void)max;
+#endif
+  return written;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::setLogOutput(Print *out)
+{
+#if RN2XX3_LOG_LEVEL > RN2XX3_LOG_NONE
+  _logOutput = out;
+#else
+  (void)out;
+#endif
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getLostLogRecords()
+{
+#if RN2XX3_LOG_LEVEL > RN2XX3_LOG_NONE
+  return _log.lost();
+#else
+  return 0;
+#endif
+}
+
+template <class Transport>
+rn2xx3_line rn2xx3_t<Transport>::sendLine(const __FlashStringHelper *command, const char *text, size_t length, unsigned long timeoutMs)
+{
+  drainUnsolicited();
+  _lastCommandRoundTrip = micros();
+  writeLine(command, text, length);
+
+  unsigned long start = millis();
+  rn2xx3_line ret = _reader.read(_serial, timeoutMs);
+  while (isTxResult(determineReceivedDataType(ret)))
+  {
+    // The late end of an uplink, not the reply
+    handleUnsolicited(ret);
+    unsigned long waited = millis() - start;
+    ret = _reader.read(_serial, waited < timeoutMs ? timeoutMs - waited : 0);
+  }
+  _lastCommandRoundTrip = micros() - _lastCommandRoundTrip;
+  received_t type = determineReceivedDataType(ret);
+  RN2XX3_LOG_AT_DEBUG(RECEIVED, type, ret.length);
+  if (ret.length > 0)
+  {
+    RN2XX3_STATS_DO(rn2xx3_stats::record(_stats.commandLatency, _lastCommandRoundTrip / 1000));
+    countReply(type);
+  }
+
+  if (ret.equals(F("invalid_param")))
+  {
+    if (command)
+      _lastErrorInvalidParam = command;
+    else
+      _lastErrorInvalidParam = text;
+  }
+
+  return ret;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::drainUnsolicited()
+{
+  // Commands wake the RN2xx3 first
+  if (_sleeping)
+    wake();
+
+  // Replies to pipelined commands are not unsolicited
+  collectBatchReplies();
+
+  // A line that is half way through arriving gets a moment to complete,
+  // otherwise the reply to the next command would be appended to it.
+  if (_reader.partial())
+  {
+    if (_reader.read(_serial, 50).length > 0)
+      handleUnsolicited(_reader.line());
+  }
+
+  while (_reader.poll(_serial))
+  {
+    handleUnsolicited(_reader.line());
+  }
+  _reader.clear();
+
+  pauseListen();
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::handleUnsolicited(const rn2xx3_line &receivedData)
+{
+  if (receivedData.length == 0)
+    return;
+
+  RN2XX3_LOG_AT_DEBUG(UNSOLICITED, determineReceivedDataType(receivedData), receivedData.length);
+
+  if (_sleeping && receivedData.equals(F("ok")))
+  {
+    // The RN2xx3 woke up at the end of its sleep
+    _wakeSeen = true;
+    return;
+  }
+
+  if (_listenState != LISTEN_OFF && handleListenLine(receivedData))
+    return;
+
+  rn2xx3_reply reply;
+  switch (reply.parse(receivedData.data, receivedData.length))
+  {
+  case rn2xx3_reply::mac_rx:
+    //example: mac_rx 1 54657374696E6720313233
+    if (storeRx(reply.port, receivedData.substring(reply.payloadOffset)))
+      dispatchDownlink();
+    break;
+
+  case rn2xx3_reply::radio_rx:
+    storeRx(0, receivedData.substring(reply.payloadOffset));
+    break;
+
+  default:
+    break;
+  }
+
+  if (_unsolicitedCallback)
+    _unsolicitedCallback(receivedData.c_str());
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::sendCommandOk(const rn2xx3_command &command)
+{
+  if (command.overflowed())
+  {
+    refuseCommand();
+    return false;
+  }
+  if (_batchDepth > 0)
+    return pipelineCommand(command.c_str(), command.length());
+  return sendCommand(command).equals(F("ok"));
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::sendCommandOk(const String &command)
+{
+  if (_batchDepth > 0)
+    return pipelineCommand(command.c_str(), command.length());
+  return sendCommand(command).equals(F("ok"));
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::beginBatch()
+{
+  if (_batchDepth == 0)
+  {
+    drainUnsolicited();
+    _batchSize = 0;
+    _batchFailures = 0;
+    memset(_batchFailed, 0, sizeof(_batchFailed));
+  }
+  _batchDepth++;
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::endBatch()
+{
+  if (_batchDepth == 0)
+    return _batchFailures;
+
+  _batchDepth--;
+  if (_batchDepth > 0)
+    return 0; // the outer batch reports the failures
+
+  collectBatchReplies();
+  return _batchFailures;
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::sendBatch(const String commands[], uint8_t count)
+{
+  beginBatch();
+  for (uint8_t i = 0; i < count; i++)
+  {
+    forgetRawCommand(commands[i]);
+    sendCommandOk(commands[i]);
+  }
+  return endBatch();
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::batchEntryFailed(uint8_t index)
+{
+  if (index >= RN2XX3_BATCH_MAX_ENTRIES)
+    return false;
+  return _batchFailed[index / 8] & (1 << (index % 8));
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::getBatchFailures()
+{
+  return _batchFailures;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::pipelineCommand(const char *command, size_t commandLength)
+{
+  size_t length = commandLength + 2; // line ending
+
+  // Only write when the unanswered commands leave room in the RN2xx3's
+  // receive buffer, otherwise it would drop characters.
+  while (_pipeCount > 0 && (_pipeCount == RN2XX3_PIPELINE_DEPTH || _pipeBytes + length > RN2XX3_PIPELINE_BYTES))
+  {
+    collectBatchReply();
+  }
+
+  writeLine(NULL, command, commandLength);
+
+  RN2XX3_STATS_DO(_pipeSentAt[(_pipeHead + _pipeCount) % RN2XX3_PIPELINE_DEPTH] = millis());
+  _pipeLengths[(_pipeHead + _pipeCount) % RN2XX3_PIPELINE_DEPTH] = length > 255 ? 255 : length;
+  _pipeBytes += length > 255 ? 255 : length;
+  _pipeCount++;
+  return true;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::collectBatchReply()
+{
+  rn2xx3_line reply = _reader.read(_serial, 2000);
+  received_t type = determineReceivedDataType(reply);
+  if (isTxResult(type))
+  {
+    // not a reply to a configuration command
+    handleUnsolicited(reply);
+    return;
+  }
+
+  if (reply.length > 0)
+    RN2XX3_STATS_DO(rn2xx3_stats::record(_stats.commandLatency, millis() - _pipeSentAt[_pipeHead]));
+  countReply(type);
+  switch (type)
+  {
+  case rn2xx3_reply::ok:
+    break;
+
+  default:
+    // A timeout also counts as a failure, so we never wait forever.
+    // The setting the command was meant to change is now unknown.
+    invalidateCache();
+    failBatchEntry();
+    break;
+  }
+
+  _pipeBytes -= _pipeLengths[_pipeHead];
+  _pipeHead = (_pipeHead + 1) % RN2XX3_PIPELINE_DEPTH;
+  _pipeCount--;
+  if (_batchSize < 255)
+    _batchSize++;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::refuseCommand()
+{
+  _commandTooLong = true;
+  if (_batchDepth == 0)
+    return;
+
+  // A failed entry of the batch, after those already written
+  collectBatchReplies();
+  failBatchEntry();
+  if (_batchSize < 255)
+    _batchSize++;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::failBatchEntry()
+{
+  if (_batchSize < RN2XX3_BATCH_MAX_ENTRIES)
+    _batchFailed[_batchSize / 8] |= 1 << (_batchSize % 8);
+  if (_batchFailures < 255)
+    _batchFailures++;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::collectBatchReplies()
+{
+  while (_pipeCount > 0)
+  {
+    collectBatchReply();
+  }
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getLastCommandRoundTrip()
+{
+  return _lastCommandRoundTrip;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::onUnsolicited(rn2xx3_unsolicited_callback_t callback)
+{
+  _unsolicitedCallback = callback;
+}
+
+template <class Transport>
+RN2xx3_t rn2xx3_t<Transport>::moduleType()
+{
+  return _moduleType;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setFrequencyPlan(FREQ_PLAN fp)
+{
+  bool returnValue;
+
+  // The channel settings do not depend on each other's reply
+  beginBatch();
+
+  switch (fp)
+  {
+  case SINGLE_CHANNEL_EU:
+  {
+    if (_moduleType == RN2483)
+    {
+      //mac set rx2 <dataRate> <frequency>
+      //set2ndRecvWindow(5, 868100000); //use this for "strict" one channel gateways
+      set2ndRecvWindow(3, 869525000); //use for "non-strict" one channel gateways
+      setChannelDutyCycle(0, 99);     //1% duty cycle for this channel
+      setChannelDutyCycle(1, 65535);  //almost never use this channel
+      setChannelDutyCycle(2, 65535);  //almost never use this channel
+      for (uint8_t ch = 3; ch < 8; ch++)
+      {
+        setChannelEnabled(ch, false);
+      }
+      returnValue = true;
+    }
+    else
+    {
+      returnValue = false;
+    }
+    break;
+  }
+
+  case TTN_EU:
+  {
+    if (_moduleType == RN2483)
+    {
+      /*
+       * The <dutyCycle> value that needs to be configured can be
+       * obtained from the actual duty cycle X (in percentage)
+       * using the following formula: <dutyCycle> = (100/X) – 1
+       *
+       *  10% -> 9
+       *  1% -> 99
+       *  0.33% -> 299
+       *  8 channels, total of 1% duty cycle:
+       *  0.125% per channel -> 799
+       *
+       * Most of the TTN_EU frequency plan was copied from:
+       * https://github.com/TheThingsNetwork/arduino-device-lib
+       */
+
+      uint32_t freq = 867100000;
+      for (uint8_t ch = 0; ch < 8; ch++)
+      {
+        setChannelDutyCycle(ch, 799); // All channels
+        if (ch == 1)
+        {
+          setChannelDataRateRange(ch, 0, 6);
+        }
+        else if (ch > 2)
+        {
+          setChannelDataRateRange(ch, 0, 5);
+          setChannelFrequency(ch, freq);
+          freq = freq + 200000;
+        }
+        setChannelEnabled(ch, true); // frequency, data rate and duty cycle must be set first.
+      }
+
+      //RX window 2
+      set2ndRecvWindow(3, 869525000);
+
+      returnValue = true;
+    }
+    else
+    {
+      returnValue = false;
+    }
+
+    break;
+  }
+
+  case TTN_US:
+  {
+    /*
+     * Most of the TTN_US frequency plan was copied from:
+     * https://github.com/TheThingsNetwork/arduino-device-lib
+     */
+    if (_moduleType == RN2903)
+    {
+      for (int channel = 0; channel < 72; channel++)
+      {
+        bool enabled = (channel >= 8 && channel < 16);
+        setChannelEnabled(channel, enabled);
+      }
+      returnValue = true;
+    }
+    else
+    {
+      returnValue = false;
+    }
+    break;
+  }
+
+  case DEFAULT_EU:
+  {
+    if (_moduleType == RN2483)
+    {
+      for (int channel = 0; channel < 8; channel++)
+      {
+        if (channel < 3)
+        {
+          //fix duty cycle - 1% = 0.33% per channel
+          setChannelDutyCycle(channel, 799);
+          setChannelEnabled(channel, true);
+        }
+        else
+        {
+          //disable non-default channels
+          setChannelEnabled(channel, false);
+        }
+      }
+      returnValue = true;
+    }
+    else
+    {
+      returnValue = false;
+    }
+
+    break;
+  }
+  default:
+  {
+    //set default channels 868.1, 868.3 and 868.5?
+    returnValue = false; //well we didn't do anything, so yes, false
+    break;
+  }
+  }
+
+  endBatch();
+  return returnValue;
+}
+
+template <class Transport>
+uint32_t rn2xx3_t<Transport>::getTimeOnAir(uint8_t payloadSize)
+{
+  if (_radio2radio)
+  {
+    // initP2P() sets SF7, 125 kHz, 4/5 and 8 symbols of preamble
+    return rn2xx3_airtime::lora(7, 125, 1, 8, payloadSize);
+  }
+  return rn2xx3_airtime::lorawan(_moduleType == RN2903, currentDataRate(), payloadSize);
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::nextTxAllowedAt()
+{
+  // The RN2903 has no duty cycle limits
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+  if (_moduleType != RN2483)
+    return millis();
+  return _dutyCycle.nextFreeAt(millis());
+#else
+  return millis();
+#endif
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::currentDataRate()
+{
+  if (_shadow.dr < 0)
+  {
+    rn2xx3_line dr = sendCommand(rn2xx3_command::MAC_GET_DR);
+    if (dr.length == 0)
+      return 0;
+    _shadow.dr = dr.toInt();
+  }
+  return _shadow.dr;
+}
+
+template <class Transport>
+uint8_t rn2xx3_t<Transport>::knownDataRate()
+{
+  // The slowest data rate errs on the safe side for size and time on air
+  return _shadow.dr >= 0 ? _shadow.dr : 0;
+}
+
+template <class Transport>
+typename rn2xx3_t<Transport>::received_t rn2xx3_t<Transport>::determineReceivedDataType(const rn2xx3_line &receivedData)
+{
+  return rn2xx3_reply::classify(receivedData.data, receivedData.length);
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::isTxResult(received_t type)
+{
+  switch (type)
+  {
+  case rn2xx3_reply::mac_rx:
+  case rn2xx3_reply::mac_tx_ok:
+  case rn2xx3_reply::mac_err:
+  case rn2xx3_reply::radio_rx:
+  case rn2xx3_reply::radio_tx_ok:
+  case rn2xx3_reply::radio_err:
+    return true;
+  default:
+    return false;
+  }
+}
+
+template <class Transport>
+int rn2xx3_t<Transport>::readIntValue(rn2xx3_command::id_t command)
+{
+  return sendCommand(command).toInt();
+}
+
+template <class Transport>
+String rn2xx3_t<Transport>::getLastErrorInvalidParam()
+{
+  String res = _lastErrorInvalidParam;
+  _lastErrorInvalidParam = "";
+  return res;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setChannelDutyCycle(unsigned int channel, unsigned int dutyCycle)
+{
+  bool cached = channel < RN2XX3_SHADOW_CHANNELS;
+  if (cacheHit(cached && (_shadow.dcycleKnown & (1 << channel)) && _shadow.dcycle[channel] == dutyCycle))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_CH_DCYCLE).arg(channel).arg(dutyCycle)))
+    return false;
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+  _dutyCycle.setDutyCycle(channel, dutyCycle);
+#endif
+  if (cached)
+  {
+    _shadow.dcycle[channel] = dutyCycle;
+    _shadow.dcycleKnown |= 1 << channel;
+  }
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setChannelFrequency(unsigned int channel, uint32_t frequency)
+{
+  bool cached = channel < RN2XX3_SHADOW_CHANNELS;
+  if (cacheHit(cached && (_shadow.freqKnown & (1 << channel)) && _shadow.freq[channel] == frequency))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_CH_FREQ).arg(channel).arg((unsigned long)frequency)))
+    return false;
+  if (cached)
+  {
+    _shadow.freq[channel] = frequency;
+    _shadow.freqKnown |= 1 << channel;
+  }
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setChannelDataRateRange(unsigned int channel, unsigned int minRange, unsigned int maxRange)
+{
+  bool cached = channel < RN2XX3_SHADOW_CHANNELS && minRange < 16 && maxRange < 16;
+  uint8_t range = (minRange << 4) | maxRange;
+  if (cacheHit(cached && (_shadow.drrangeKnown & (1 << channel)) && _shadow.drrange[channel] == range))
+    return true;
+
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_CH_DRRANGE).arg(channel).arg(minRange).arg(maxRange)))
+    return false;
+  if (cached)
+  {
+    _shadow.drrange[channel] = range;
+    _shadow.drrangeKnown |= 1 << channel;
+  }
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setChannelEnabled(unsigned int channel, bool enabled)
+{
+  bool cached = channel < RN2XX3_MAX_CHANNELS;
+  uint8_t mask = 1 << (channel % 8);
+  if (cacheHit(cached && (_shadow.statusKnown[channel / 8] & mask) && ((_shadow.statusOn[channel / 8] & mask) != 0) == enabled))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_CH_STATUS).arg(channel).argOnOff(enabled)))
+    return false;
+#if RN2XX3_DUTY_CYCLE_CHANNELS > 0
+  _dutyCycle.setEnabled(channel, enabled);
+#endif
+  if (cached)
+  {
+    _shadow.statusKnown[channel / 8] |= mask;
+    if (enabled)
+      _shadow.statusOn[channel / 8] |= mask;
+    else
+      _shadow.statusOn[channel / 8] &= ~mask;
+  }
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::set2ndRecvWindow(unsigned int dataRate, uint32_t frequency)
+{
+  if (cacheHit(_shadow.rx2DataRate == (int)dataRate && _shadow.rx2Frequency == frequency))
+    return true;
+
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_RX2).arg(dataRate).arg((unsigned long)frequency)))
+    return false;
+  _shadow.rx2DataRate = dataRate;
+  _shadow.rx2Frequency = frequency;
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setAdaptiveDataRate(bool enabled)
+{
+  if (cacheHit(_shadow.adr == enabled))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_ADR).argOnOff(enabled)))
+    return false;
+  _shadow.adr = enabled;
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setAutomaticReply(bool enabled)
+{
+  _automaticReply = enabled;
+  if (cacheHit(_shadow.ar == enabled))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_AR).argOnOff(enabled)))
+    return false;
+  _shadow.ar = enabled;
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::setTXoutputPower(int pwridx)
+{
+  if (cacheHit(_shadow.pwridx == pwridx))
+    return true;
+  if (!sendCommandOk(rn2xx3_command(rn2xx3_command::MAC_SET_PWRIDX).arg(pwridx)))
+    return false;
+  _shadow.pwridx = pwridx;
+  return true;
+}
+
+template <class Transport>
+bool rn2xx3_t<Transport>::cacheHit(bool matches)
+{
+  if (matches)
+    _cacheHits++;
+  else
+    _cacheMisses++;
+  return matches;
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::invalidateCache()
+{
+  _radioKnown = 0;
+  _shadow.adr = -1;
+  _shadow.ar = -1;
+  invalidateNetworkControlled(true);
+}
+
+template <class Transport>
+void rn2xx3_t<Transport>::invalidateNetworkControlled(bool dataRate)
+{
+  if (dataRate)
+  {
+    _shadow.dr = -1;
+    _shadow.pwridx = -1;
+  }
+  _shadow.rx2DataRate = -1;
+  _shadow.rx2Frequency = 0;
+  memset(_shadow.statusKnown, 0, sizeof(_shadow.statusKnown));
+  _shadow.dcycleKnown = 0;
+  _shadow.freqKnown = 0;
+  _shadow.drrangeKnown = 0;
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getCacheHits()
+{
+  return _cacheHits;
+}
+
+template <class Transport>
+unsigned long rn2xx3_t<Transport>::getCacheMisses()
+{
+  return _cacheMisses;
+}
+
+#undef RN2XX3_LOG_AT_ERROR
+#undef RN2XX3_LOG_AT_INFO
+#undef RN2XX3_LOG_AT_DEBUG
+#undef RN2XX3_STATS_DO
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Allocation free line assembler for the responses of a Microchip RN2xx3 LoRa radio.
+ *
+ * @Date 18/10/2026
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_line.h"
+
+extern "C"
+{
+#include <string.h>
+#include <stdlib.h>
+}
+
+bool rn2xx3_line::startsWith(const __FlashStringHelper *prefix) const
+{
+  PGM_P p = reinterpret_cast<PGM_P>(prefix);
+  size_t len = strlen_P(p);
+  return len <= length && strncmp_P(data, p, len) == 0;
+}
+
+bool rn2xx3_line::equals(const __FlashStringHelper *text) const
+{
+  PGM_P p = reinterpret_cast<PGM_P>(text);
+  return strlen_P(p) == length && strncmp_P(data, p, length) == 0;
+}
+
+int rn2xx3_line::indexOf(char c, uint16_t from) const
+{
+  for (uint16_t i = from; i < length; i++)
+  {
+    if (data[i] == c)
+      return i;
+  }
+  return -1;
+}
+
+rn2xx3_line rn2xx3_line::substring(uint16_t from) const
+{
+  rn2xx3_line tail;
+  if (from > length)
+    from = length;
+  tail.data = data + from;
+  tail.length = length - from;
+  return tail;
+}
+
+long rn2xx3_line::toInt() const
+{
+  return atol(data);
+}
+
+rn2xx3_line_reader::rn2xx3_line_reader() : _length(0), _ready(false), _overflow(false), _bytesRead(0)
+{
+  _buffer[0] = '\0';
+}
+
+rn2xx3_line rn2xx3_line_reader::line() const
+{
+  rn2xx3_line current;
+  current.data = _buffer;
+  current.length = _length;
+  return current;
+}
+
+bool rn2xx3_line_reader::partial() const
+{
+  return !_ready && _length > 0;
+}
+
+bool rn2xx3_line_reader::overflowed() const
+{
+  return _overflow;
+}
+
+void rn2xx3_line_reader::clear()
+{
+  _length = 0;
+  _buffer[0] = '\0';
+  _ready = false;
+  _overflow = false;
+}
+
+unsigned long rn2xx3_line_reader::bytesRead() const
+{
+  return _bytesRead;
+}
@@ -0,0 +1,167 @@
+/*
+ * Allocation free line assembler for the responses of a Microchip RN2xx3 LoRa radio.
+ *
+ * @Date 18/10/2026
+ *
+ */
+
+#ifndef rn2xx3_line_h
+#define rn2xx3_line_h
+
+#include "Arduino.h"
+
+/*
+ * Size of the buffer holding one response line, including the terminating
+ * null character. The longest line the RN2xx3 sends is a downlink
+ * ("mac_rx <port> <hex>" or "radio_rx  <hex>"), so this limits the
+ * largest downlink payload to (RN2XX3_LINE_BUFFER_SIZE - 12) / 2 bytes:
+ * 58 on AVR, and the 255 of a LoRa frame elsewhere.
+ * Lines that do not fit are truncated. rn2xx3 drops downlinks that were
+ * truncated and counts them in rn2xx3_stats::longDownlinks.
+ * Set it for the whole build, as the library is compiled on its own
+ * (see rn2xx3.h).
+ */
+#ifndef RN2XX3_LINE_BUFFER_SIZE
+#if defined(__AVR__)
+#define RN2XX3_LINE_BUFFER_SIZE 128
+#else
+#define RN2XX3_LINE_BUFFER_SIZE 528
+#endif
+#endif
+
+/*
+ * A non-owning view on (the tail of) a received line.
+ * The characters are null terminated and stay valid until the next line
+ * is read from the RN2xx3.
+ */
+struct rn2xx3_line
+{
+  const char *data;
+  uint16_t length;
+
+  bool startsWith(const __FlashStringHelper *prefix) const;
+  bool equals(const __FlashStringHelper *text) const;
+
+  /*
+     * Returns the position of the first c at or after from, or -1.
+     */
+  int indexOf(char c, uint16_t from = 0) const;
+
+  /*
+     * Returns the part of the line starting at from.
+     */
+  rn2xx3_line substring(uint16_t from) const;
+
+  long toInt() const;
+
+  const char *c_str() const
+  {
+    return data;
+  }
+};
+
+class rn2xx3_line_reader
+{
+public:
+  rn2xx3_line_reader();
+
+  /*
+     * Move the bytes already available on the serial port into the buffer.
+     * serial is any Stream, or a serial port class with the same
+     * available() and read(), whose reads can then be inlined.
+     * Never waits. Returns true once a complete line is available.
+     * The next call after that starts a new line.
+     */
+  template <class Transport>
+  bool poll(Transport &serial);
+
+  /*
+     * Wait at most timeoutMs for a complete line.
+     * Returns an empty line on timeout.
+     */
+  template <class Transport>
+  rn2xx3_line read(Transport &serial, unsigned long timeoutMs);
+
+  /*
+     * The current line, without the line ending.
+     */
+  rn2xx3_line line() const;
+
+  /*
+     * Returns true if part of a line was received, but not its line ending.
+     */
+  bool partial() const;
+
+  /*
+     * Returns true if the current line was longer than the buffer.
+     */
+  bool overflowed() const;
+
+  /*
+     * Throw away the current (partial) line.
+     */
+  void clear();
+
+  /*
+     * The number of bytes taken from the serial port, line endings included.
+     */
+  unsigned long bytesRead() const;
+
+private:
+  char _buffer[RN2XX3_LINE_BUFFER_SIZE];
+  uint16_t _length;
+  bool _ready;
+  bool _overflow;
+  unsigned long _bytesRead;
+};
+
+template <class Transport>
+bool rn2xx3_line_reader::poll(Transport &serial)
+{
+  if (_ready)
+  {
+    clear();
+  }
+
+  while (serial.available())
+  {
+    int c = serial.read();
+    _bytesRead++;
+    if (c == '\n')
+    {
+      _ready = true;
+      return true;
+    }
+    if (c < 0 || c == '\r')
+      continue;
+
+    if (_length < sizeof(_buffer) - 1)
+    {
+      _buffer[_length++] = (char)c;
+      _buffer[_length] = '\0';
+    }
+    else
+    {
+      _overflow = true;
+    }
+  }
+  return false;
+}
+
+template <class Transport>
+rn2xx3_line rn2xx3_line_reader::read(Transport &serial, unsigned long timeoutMs)
+{
+  unsigned long start = millis();
+  while (!poll(serial))
+  {
+    if (millis() - start >= timeoutMs)
+    {
+      clear();
+      break;
+    }
+    yield();
+  }
+  return line();
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Deferred binary logging for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_log.h"
+
+// One string in program memory per event
+#define RN2XX3_LOG_EVENT_TEXT(id, text) static const char EVENT_##id[] PROGMEM = text;
+RN2XX3_LOG_EVENTS(RN2XX3_LOG_EVENT_TEXT)
+#undef RN2XX3_LOG_EVENT_TEXT
+
+// And a table of them, in the order of rn2xx3_log::event_t
+#define RN2XX3_LOG_EVENT_ENTRY(id, text) EVENT_##id,
+static const char *const EVENTS[rn2xx3_log::COUNT] PROGMEM = {
+    RN2XX3_LOG_EVENTS(RN2XX3_LOG_EVENT_ENTRY)};
+#undef RN2XX3_LOG_EVENT_ENTRY
+
+rn2xx3_log::rn2xx3_log() : _first(0), _count(0), _lost(0)
+{
+}
+
+const __FlashStringHelper *rn2xx3_log::text(event_t event)
+{
+  return reinterpret_cast<const __FlashStringHelper *>(pgm_read_ptr(&EVENTS[event]));
+}
+
+void rn2xx3_log::push(event_t event, uint8_t detail, uint32_t value)
+{
+  if (_count == RN2XX3_LOG_ENTRIES)
+  {
+    // The newest records tell most about a problem
+    _first = (_first + 1) % RN2XX3_LOG_ENTRIES;
+    _count--;
+    _lost++;
+  }
+
+  rn2xx3_log_record &record = _records[(_first + _count) % RN2XX3_LOG_ENTRIES];
+  record.at = millis();
+  record.value = value;
+  record.event = event;
+  record.detail = detail;
+  _count++;
+}
+
+bool rn2xx3_log::pop(rn2xx3_log_record &record)
+{
+  if (_count == 0)
+    return false;
+  record = _records[_first];
+  _first = (_first + 1) % RN2XX3_LOG_ENTRIES;
+  _count--;
+  return true;
+}
+
+void rn2xx3_log::print(Print &out, const rn2xx3_log_record &record)
+{
+  out.print(F("[LoRa] ["));
+  out.print(record.at);
+  out.print(F("] "));
+  if (record.event < COUNT)
+    out.print(text((event_t)record.event));
+  out.print(' ');
+  out.print(record.detail);
+  out.print(' ');
+  out.println((unsigned long)record.value);
+}
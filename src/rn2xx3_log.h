@@ -0,0 +1,98 @@
+/*
+ * Deferred binary logging for a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_log_h
+#define rn2xx3_log_h
+
+#include "Arduino.h"
+
+#define RN2XX3_LOG_NONE 0
+#define RN2XX3_LOG_ERROR 1
+#define RN2XX3_LOG_INFO 2
+#define RN2XX3_LOG_DEBUG 3
+
+/*
+ * Events up to this level are logged, the others are not compiled in.
+ * The default leaves logging out completely. Set it for the whole build,
+ * for example with -DRN2XX3_LOG_LEVEL=3, as the library is compiled on
+ * its own.
+ */
+#ifndef RN2XX3_LOG_LEVEL
+#define RN2XX3_LOG_LEVEL RN2XX3_LOG_NONE
+#endif
+
+// Records kept until they are flushed; when full the oldest are overwritten
+#ifndef RN2XX3_LOG_ENTRIES
+#ifdef __AVR__
+#define RN2XX3_LOG_ENTRIES 8
+#else
+#define RN2XX3_LOG_ENTRIES 32
+#endif
+#endif
+
+/*
+ * The events, with what their detail and value hold. Reply types are
+ * those of rn2xx3_reply::type_t.
+ */
+#define RN2XX3_LOG_EVENTS(X)                                           \
+  X(FOUND_MODULE, "found module")       /* -, RN2xx3_t */              \
+  X(RESUMED, "resumed session")         /* 1 for OTAA, 0 for ABP */    \
+  X(LISTENING, "listening")             /* - */                        \
+  X(TX_SENT, "tx sent")                 /* attempt, payload bytes */   \
+  X(RECEIVED, "received")               /* reply type, line length */  \
+  X(TX_RESULT, "tx result")             /* reply type, line length */  \
+  X(TX_ERROR, "tx error")               /* reply type */               \
+  X(UNSOLICITED, "unsolicited")         /* reply type, line length */
+
+struct rn2xx3_log_record
+{
+  unsigned long at; // millis()
+  uint32_t value;
+  uint8_t event;
+  uint8_t detail;
+};
+
+/*
+ * A ring of log records. Adding one only stores a few numbers, so it
+ * does not change the timing of the radio. Formatting them as text is
+ * left to idle time.
+ */
+class rn2xx3_log
+{
+public:
+#define RN2XX3_LOG_EVENT_ID(id, text) id,
+  enum event_t
+  {
+    RN2XX3_LOG_EVENTS(RN2XX3_LOG_EVENT_ID)
+        COUNT
+  };
+#undef RN2XX3_LOG_EVENT_ID
+
+  rn2xx3_log();
+
+  void push(event_t event, uint8_t detail, uint32_t value);
+
+  // Take the oldest record. Returns false when there is none.
+  bool pop(rn2xx3_log_record &record);
+
+  uint8_t count() const { return _count; }
+
+  // Records overwritten before they were flushed
+  unsigned long lost() const { return _lost; }
+
+  // Write a record as a line of text
+  static void print(Print &out, const rn2xx3_log_record &record);
+
+  // The name of an event, in program memory
+  static const __FlashStringHelper *text(event_t event);
+
+private:
+  rn2xx3_log_record _records[RN2XX3_LOG_ENTRIES];
+  uint8_t _first;
+  uint8_t _count;
+  unsigned long _lost;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Drives several Microchip RN2xx3 LoRa radios on separate UARTs at once.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_manager.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+rn2xx3_manager::rn2xx3_manager() : _count(0), _next(0), _callback(NULL)
+{
+  memset(_sending, 0, sizeof(_sending));
+  resetUsage();
+}
+
+bool rn2xx3_manager::add(rn2xx3 &radio)
+{
+  if (_count == RN2XX3_MANAGER_RADIOS)
+    return false;
+  _radios[_count] = &radio;
+  _sending[_count] = false;
+  _count++;
+  return true;
+}
+
+int8_t rn2xx3_manager::send(const uint8_t *data, uint8_t size, bool confirmed)
+{
+#if RN2XX3_MANAGER_FRAME_BYTES < 255
+  if (size > RN2XX3_MANAGER_FRAME_BYTES)
+    return -1;
+#endif
+
+  unsigned long now = millis();
+  for (uint8_t n = 0; n < _count; n++)
+  {
+    uint8_t i = (_next + n) % _count;
+    if (_sending[i] || _radios[i]->txPending() || _radios[i]->rejoinNeeded())
+      continue;
+    if ((long)(_radios[i]->nextTxAllowedAt() - now) > 0)
+      continue;
+
+    memcpy(_frames[i], data, size);
+    if (!_radios[i]->beginTxBytes(_frames[i], size, confirmed))
+      continue;
+    _sending[i] = true;
+    _startedAt[i] = now;
+    _next = (i + 1) % _count;
+    return i;
+  }
+  return -1;
+}
+
+bool rn2xx3_manager::poll()
+{
+  bool pending = false;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    // Each poll() only handles what already arrived on its UART
+    if (_radios[i]->poll())
+    {
+      pending = true;
+      continue;
+    }
+    if (!_sending[i])
+      continue;
+
+    _sending[i] = false;
+    TX_RETURN_TYPE result = _radios[i]->txResult();
+    _usage[i].busyMs += millis() - _startedAt[i];
+    _usage[i].frames++;
+    if (result == TX_FAIL)
+      _usage[i].failures++;
+    if (_callback)
+      _callback(i, result);
+  }
+  return pending;
+}
+
+bool rn2xx3_manager::busy(uint8_t index)
+{
+  return index < _count && (_sending[index] || _radios[index]->txPending());
+}
+
+unsigned long rn2xx3_manager::nextFreeAt()
+{
+  unsigned long now = millis();
+  unsigned long earliest = 0;
+  bool found = false;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (busy(i))
+      continue;
+    unsigned long at = _radios[i]->nextTxAllowedAt();
+    if ((long)(at - now) <= 0)
+      return now;
+    if (!found || (long)(at - earliest) < 0)
+      earliest = at;
+    found = true;
+  }
+
+  // All radios are sending; one of them is free soon after it completes
+  return found ? earliest : now;
+}
+
+void rn2xx3_manager::onTxDone(rn2xx3_manager_callback_t callback)
+{
+  _callback = callback;
+}
+
+void rn2xx3_manager::getUsage(uint8_t index, rn2xx3_radio_usage &usage)
+{
+  usage = _usage[index];
+  usage.periodMs = millis() - _usageSince;
+  if (_sending[index])
+    usage.busyMs += millis() - _startedAt[index];
+}
+
+void rn2xx3_manager::resetUsage()
+{
+  memset(_usage, 0, sizeof(_usage));
+  _usageSince = millis();
+  for (uint8_t i = 0; i < RN2XX3_MANAGER_RADIOS; i++)
+    _startedAt[i] = _usageSince;
+}
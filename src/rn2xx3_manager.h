@@ -0,0 +1,121 @@
+/*
+ * Drives several Microchip RN2xx3 LoRa radios on separate UARTs at once.
+ *
+ */
+
+#ifndef rn2xx3_manager_h
+#define rn2xx3_manager_h
+
+#include "Arduino.h"
+#include "rn2xx3.h"
+
+// Radios one manager can own
+#ifndef RN2XX3_MANAGER_RADIOS
+#ifdef __AVR__
+#define RN2XX3_MANAGER_RADIOS 2
+#else
+#define RN2XX3_MANAGER_RADIOS 8
+#endif
+#endif
+
+// Largest frame send() accepts; each radio keeps a copy while it sends
+#ifndef RN2XX3_MANAGER_FRAME_BYTES
+#ifdef __AVR__
+#define RN2XX3_MANAGER_FRAME_BYTES 64
+#else
+#define RN2XX3_MANAGER_FRAME_BYTES 255
+#endif
+#endif
+
+/*
+ * Called from poll() when a frame started by send() completes on a radio.
+ */
+typedef void (*rn2xx3_manager_callback_t)(uint8_t radio, TX_RETURN_TYPE result);
+
+// What a radio did for the manager since resetUsage()
+struct rn2xx3_radio_usage
+{
+  unsigned long busyMs; // time with a frame of send() in progress
+  unsigned long frames;
+  unsigned long failures;
+  unsigned long periodMs; // time since resetUsage()
+};
+
+/*
+ * Spreads frames over the radios it owns. Each frame goes to a radio
+ * that has no transmission in progress and, for an RN2483, a channel
+ * the duty cycle leaves free. The radios are tried in turn, starting
+ * after the one used last, so the load is shared. A radio that needs
+ * rejoin() is skipped until the application has called it.
+ *
+ * The radios are initialised by the application, one after the other,
+ * with initOTAA(), initABP() or initP2P() as usual. From then on only
+ * the non-blocking transmissions are used, so while one radio waits for
+ * its RX windows the others can send:
+ *
+ *   rn2xx3_manager radios;
+ *   radios.add(loraA);
+ *   radios.add(loraB);
+ *   ...
+ *   if (radios.send(payload, length) < 0)
+ *     // all radios busy, try again after radios.nextFreeAt()
+ *   radios.poll();
+ */
+class rn2xx3_manager
+{
+public:
+  rn2xx3_manager();
+
+  // Returns false when RN2XX3_MANAGER_RADIOS are added already
+  bool add(rn2xx3 &radio);
+
+  uint8_t count() const { return _count; }
+  rn2xx3 &radio(uint8_t index) { return *_radios[index]; }
+
+  /*
+     * Start sending a frame on a free radio. The bytes are copied.
+     * Starting waits for that radio as rn2xx3::beginTx() describes.
+     * Returns the index of the radio, or -1 when none can send now or
+     * the frame is longer than RN2XX3_MANAGER_FRAME_BYTES.
+     */
+  int8_t send(const uint8_t *data, uint8_t size, bool confirmed = false);
+
+  /*
+     * Drive the transmissions of all radios. Never waits for a radio
+     * that is sending; an idle one may start a queued frame, see
+     * rn2xx3::poll().
+     * Returns true while any of them is still sending.
+     */
+  bool poll();
+
+  // True while the radio at index has a transmission in progress
+  bool busy(uint8_t index);
+
+  /*
+     * The millis() value at which send() can next find a radio, which is
+     * now if one can send already.
+     */
+  unsigned long nextFreeAt();
+
+  void onTxDone(rn2xx3_manager_callback_t callback);
+
+  /*
+     * What the radio at index did since resetUsage(). Its busy share of
+     * the period shows how many radios a deployment needs.
+     */
+  void getUsage(uint8_t index, rn2xx3_radio_usage &usage);
+  void resetUsage();
+
+private:
+  rn2xx3 *_radios[RN2XX3_MANAGER_RADIOS];
+  uint8_t _frames[RN2XX3_MANAGER_RADIOS][RN2XX3_MANAGER_FRAME_BYTES];
+  bool _sending[RN2XX3_MANAGER_RADIOS];
+  unsigned long _startedAt[RN2XX3_MANAGER_RADIOS];
+  rn2xx3_radio_usage _usage[RN2XX3_MANAGER_RADIOS];
+  unsigned long _usageSince;
+  uint8_t _count;
+  uint8_t _next; // the radio to try first
+  rn2xx3_manager_callback_t _callback;
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Schema driven packing of sensor values into compact binary payloads.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_payload.h"
+
+extern "C"
+{
+#include <math.h>
+}
+
+static void readField(const rn2xx3_field *schema, uint8_t index, rn2xx3_field &field)
+{
+  memcpy_P(&field, &schema[index], sizeof(field));
+}
+
+rn2xx3_packer::rn2xx3_packer(const rn2xx3_field *schema, uint8_t fields, uint8_t *buffer, uint8_t size)
+    : _schema(schema), _fields(fields), _field(0), _buffer(buffer), _size(size), _bit(0), _overflow(false)
+{
+}
+
+uint8_t rn2xx3_packer::size(const rn2xx3_field *schema, uint8_t fields)
+{
+  uint16_t bits = 0;
+  for (uint8_t i = 0; i < fields; i++)
+  {
+    rn2xx3_field field;
+    readField(schema, i, field);
+    bits += field.bits;
+  }
+  return (bits + 7) / 8;
+}
+
+void rn2xx3_packer::put(uint32_t raw, uint8_t bits)
+{
+  if (_overflow || _bit + bits > _size * 8U)
+  {
+    _overflow = true;
+    return;
+  }
+
+  while (bits > 0)
+  {
+    uint8_t room = 8 - (_bit % 8);
+    uint8_t take = bits < room ? bits : room;
+    uint8_t chunk = (raw >> (bits - take)) & ((1U << take) - 1);
+    if (room == 8)
+      _buffer[_bit / 8] = 0;
+    _buffer[_bit / 8] |= chunk << (room - take);
+    bits -= take;
+    _bit += take;
+  }
+}
+
+void rn2xx3_packer::constants()
+{
+  rn2xx3_field field;
+  while (_field < _fields)
+  {
+    readField(_schema, _field, field);
+    if (field.scale != 0)
+      break;
+    put((uint32_t)(long)field.offset, field.bits);
+    _field++;
+  }
+}
+
+rn2xx3_packer &rn2xx3_packer::add(double value)
+{
+  constants();
+  if (_field >= _fields)
+  {
+    _overflow = true;
+    return *this;
+  }
+
+  rn2xx3_field field;
+  readField(_schema, _field++, field);
+
+  // Saturate to the range of the field instead of wrapping around. Only
+  // the limits, powers of two, are compared as a double: on AVR a double
+  // is a float, which can not hold 2^32 - 1.
+  double scaled = floor((value - field.offset) * field.scale + 0.5);
+  double limit = ldexp(1, field.isSigned ? field.bits - 1 : field.bits);
+  uint32_t max = 0xFFFFFFFFUL >> (32 - field.bits);
+  if (field.isSigned)
+    max >>= 1;
+
+  uint32_t raw;
+  if (scaled >= limit)
+    raw = max;
+  else if (scaled < (field.isSigned ? -limit : 0))
+    raw = field.isSigned ? ~max : 0;
+  else
+    raw = scaled < 0 ? (uint32_t)(long)scaled : (uint32_t)scaled;
+  put(raw, field.bits);
+
+  // Trailing constants, so the payload is complete after the last value
+  constants();
+  return *this;
+}
+
+rn2xx3_unpacker::rn2xx3_unpacker(const rn2xx3_field *schema, uint8_t fields, const uint8_t *buffer, uint8_t size)
+    : _schema(schema), _fields(fields), _field(0), _buffer(buffer), _size(size), _bit(0), _overflow(false)
+{
+}
+
+uint32_t rn2xx3_unpacker::get(uint8_t bits)
+{
+  if (_overflow || _bit + bits > _size * 8U)
+  {
+    _overflow = true;
+    return 0;
+  }
+
+  uint32_t raw = 0;
+  while (bits > 0)
+  {
+    uint8_t room = 8 - (_bit % 8);
+    uint8_t take = bits < room ? bits : room;
+    uint8_t chunk = (_buffer[_bit / 8] >> (room - take)) & ((1U << take) - 1);
+    raw = (raw << take) | chunk;
+    bits -= take;
+    _bit += take;
+  }
+  return raw;
+}
+
+double rn2xx3_unpacker::next()
+{
+  if (_field >= _fields)
+  {
+    _overflow = true;
+    return 0;
+  }
+
+  rn2xx3_field field;
+  readField(_schema, _field++, field);
+  uint32_t raw = get(field.bits);
+  if (_overflow)
+    return 0;
+  if (field.scale == 0)
+    return raw;
+
+  double value = raw;
+  if (field.isSigned && field.bits < 32 && (raw & (1UL << (field.bits - 1))))
+    value -= ldexp(1, field.bits);
+  else if (field.isSigned && field.bits == 32)
+    value = (int32_t)raw;
+  return value / field.scale + field.offset;
+}
@@ -0,0 +1,112 @@
+/*
+ * Schema driven packing of sensor values into compact binary payloads.
+ *
+ */
+
+#ifndef rn2xx3_payload_h
+#define rn2xx3_payload_h
+
+#include "Arduino.h"
+
+/*
+ * One field of a payload. A value is stored as the integer
+ * round((value - offset) * scale) in bits bits, two's complement when
+ * isSigned is set, and limited to the range of those bits.
+ * A field with scale 0 is a constant with the value offset, for example
+ * the channel and type bytes of a Cayenne LPP style layout.
+ *
+ * Fields are packed most significant bit first without padding, so the
+ * schema decides the layout down to the bit. A schema is an array of
+ * fields in program memory:
+ *
+ *   static const rn2xx3_field MAPPER[] PROGMEM = {
+ *       {24, false, 16777215 / 180.0, -90},  // latitude
+ *       {24, false, 16777215 / 360.0, -180}, // longitude
+ *       {16, true, 1, 0},                    // altitude in m
+ *       {8, false, 10, 0}};                  // HDOP
+ */
+struct rn2xx3_field
+{
+  uint8_t bits; // 1 to 32
+  bool isSigned;
+  double scale;
+  double offset;
+};
+
+/*
+ * Packs values one field at a time straight into a caller's buffer,
+ * without heap allocation:
+ *
+ *   uint8_t buffer[9];
+ *   rn2xx3_packer packer(MAPPER, 4, buffer, sizeof(buffer));
+ *   packer.add(lat).add(lon).add(alt).add(hdop);
+ *   myLora.txBytes(buffer, packer.length());
+ */
+class rn2xx3_packer
+{
+public:
+  rn2xx3_packer(const rn2xx3_field *schema, uint8_t fields, uint8_t *buffer, uint8_t size);
+
+  /*
+     * Pack the value of the next field. Constant fields before it are
+     * written first.
+     */
+  rn2xx3_packer &add(double value);
+
+  // Bytes written so far, including a partly filled last byte
+  uint8_t length() const { return (_bit + 7) / 8; }
+
+  // True when the buffer was too small or there were more values than fields
+  bool overflowed() const { return _overflow; }
+
+  /*
+     * The number of bytes a schema packs into.
+     */
+  static uint8_t size(const rn2xx3_field *schema, uint8_t fields);
+
+private:
+  void constants();
+  void put(uint32_t raw, uint8_t bits);
+
+  const rn2xx3_field *_schema;
+  uint8_t _fields;
+  uint8_t _field;
+  uint8_t *_buffer;
+  uint8_t _size;
+  uint16_t _bit;
+  bool _overflow;
+};
+
+/*
+ * Reads the values of a payload back, using the same schema. Meant for
+ * the receiving side and for tests on the host, but works on the board.
+ */
+class rn2xx3_unpacker
+{
+public:
+  rn2xx3_unpacker(const rn2xx3_field *schema, uint8_t fields, const uint8_t *buffer, uint8_t size);
+
+  // True while fields are left
+  bool available() const { return _field < _fields; }
+
+  /*
+     * The value of the next field, including constant fields.
+     * Returns 0 and sets overflowed() when the payload is too short.
+     */
+  double next();
+
+  bool overflowed() const { return _overflow; }
+
+private:
+  uint32_t get(uint8_t bits);
+
+  const rn2xx3_field *_schema;
+  uint8_t _fields;
+  uint8_t _field;
+  const uint8_t *_buffer;
+  uint8_t _size;
+  uint16_t _bit;
+  bool _overflow;
+};
+
+#endif
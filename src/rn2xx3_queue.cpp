@@ -0,0 +1,194 @@
+/*
+ * Queue of uplink messages for a Microchip RN2xx3 LoRa radio, which packs
+ * several messages into one LoRaWAN frame.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_queue.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+#if RN2XX3_QUEUE_BYTES > 0
+static void reverse(uint8_t *begin, uint8_t *end)
+{
+  while (begin < end)
+  {
+    uint8_t b = *begin;
+    *begin++ = *--end;
+    *end = b;
+  }
+}
+
+rn2xx3_queue::rn2xx3_queue()
+    : _bytes(0), _count(0), _frameMessages(0), _frameBytes(0)
+{
+}
+
+uint16_t rn2xx3_queue::offsetOf(uint8_t index) const
+{
+  uint16_t offset = 0;
+  for (uint8_t i = 0; i < index; i++)
+    offset += 1 + _buffer[offset];
+  return offset;
+}
+
+bool rn2xx3_queue::push(const uint8_t *data, uint8_t size, uint8_t priority, unsigned long deadline)
+{
+  if (_count == RN2XX3_QUEUE_ENTRIES || _bytes + 1 + size > RN2XX3_QUEUE_BYTES)
+    return false;
+
+  _buffer[_bytes] = size;
+  memcpy(_buffer + _bytes + 1, data, size);
+  _bytes += 1 + size;
+  _priority[_count] = priority;
+  _deadline[_count] = deadline;
+  _count++;
+  return true;
+}
+
+bool rn2xx3_queue::due(unsigned long nowMs, uint16_t capacity) const
+{
+  if (_count == 0 || sending())
+    return false;
+  if (_bytes >= capacity)
+    return true;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_priority[i] == 0 || (long)(nowMs - _deadline[i]) >= 0)
+      return true;
+  }
+  return false;
+}
+
+void rn2xx3_queue::move(uint8_t from, uint8_t to)
+{
+  // Rotate the bytes from message to up to the end of message from
+  uint16_t start = offsetOf(to);
+  uint16_t message = offsetOf(from);
+  uint16_t end = message + 1 + _buffer[message];
+  reverse(_buffer + start, _buffer + message);
+  reverse(_buffer + message, _buffer + end);
+  reverse(_buffer + start, _buffer + end);
+
+  uint8_t priority = _priority[from];
+  unsigned long deadline = _deadline[from];
+  for (uint8_t i = from; i > to; i--)
+  {
+    _priority[i] = _priority[i - 1];
+    _deadline[i] = _deadline[i - 1];
+  }
+  _priority[to] = priority;
+  _deadline[to] = deadline;
+}
+
+uint16_t rn2xx3_queue::prepareFrame(uint16_t capacity)
+{
+  if (sending())
+    return 0;
+  if (capacity > RN2XX3_QUEUE_BYTES)
+    capacity = RN2XX3_QUEUE_BYTES;
+
+  uint16_t used = 0;
+  uint8_t placed = 0;
+  while (placed < _count)
+  {
+    // The most urgent message that still fits, the oldest among equals
+    int8_t best = -1;
+    uint16_t offset = offsetOf(placed);
+    for (uint8_t i = placed; i < _count; i++)
+    {
+      uint16_t size = 1 + _buffer[offset];
+      if (used + size <= capacity && (best < 0 || _priority[i] < _priority[best]))
+        best = i;
+      offset += size;
+    }
+    if (best < 0)
+      break;
+
+    if (best != placed)
+      move(best, placed);
+    used += 1 + _buffer[offsetOf(placed)];
+    placed++;
+  }
+
+  _frameMessages = placed;
+  _frameBytes = used;
+  return used;
+}
+
+void rn2xx3_queue::remove(uint8_t index)
+{
+  uint16_t offset = offsetOf(index);
+  uint16_t size = 1 + _buffer[offset];
+  memmove(_buffer + offset, _buffer + offset + size, _bytes - offset - size);
+  _bytes -= size;
+  for (uint8_t i = index; i + 1 < _count; i++)
+  {
+    _priority[i] = _priority[i + 1];
+    _deadline[i] = _deadline[i + 1];
+  }
+  _count--;
+}
+
+uint8_t rn2xx3_queue::completeFrame()
+{
+  uint8_t messages = _frameMessages;
+  memmove(_buffer, _buffer + _frameBytes, _bytes - _frameBytes);
+  _bytes -= _frameBytes;
+  for (uint8_t i = messages; i < _count; i++)
+  {
+    _priority[i - messages] = _priority[i];
+    _deadline[i - messages] = _deadline[i];
+  }
+  _count -= messages;
+  _frameMessages = 0;
+  _frameBytes = 0;
+  return messages;
+}
+
+uint8_t rn2xx3_queue::dropLarger(uint16_t capacity)
+{
+  if (sending())
+    return 0;
+
+  uint8_t dropped = 0;
+  uint8_t i = 0;
+  while (i < _count)
+  {
+    if (1 + _buffer[offsetOf(i)] > capacity)
+    {
+      remove(i);
+      dropped++;
+    }
+    else
+    {
+      i++;
+    }
+  }
+  return dropped;
+}
+#endif
+
+int rn2xx3_queue::unpack(const uint8_t *frame, uint16_t length, const uint8_t **messages, uint8_t *lengths, uint8_t max)
+{
+  int count = 0;
+  uint16_t offset = 0;
+  while (offset < length)
+  {
+    uint8_t size = frame[offset];
+    if (offset + 1 + size > length)
+      return -1;
+    if (count < max)
+    {
+      messages[count] = frame + offset + 1;
+      lengths[count] = size;
+    }
+    count++;
+    offset += 1 + size;
+  }
+  return count;
+}
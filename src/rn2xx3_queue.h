@@ -0,0 +1,111 @@
+/*
+ * Queue of uplink messages for a Microchip RN2xx3 LoRa radio, which packs
+ * several messages into one LoRaWAN frame.
+ *
+ */
+
+#ifndef rn2xx3_queue_h
+#define rn2xx3_queue_h
+
+#include "Arduino.h"
+
+/*
+ * Room for queued messages, including one length byte per message.
+ * The largest frame is limited to this size as well. 0 leaves the queue
+ * out of rn2xx3; queueUplink() then returns false.
+ */
+#ifndef RN2XX3_QUEUE_BYTES
+#ifdef __AVR__
+#define RN2XX3_QUEUE_BYTES 64
+#else
+#define RN2XX3_QUEUE_BYTES 242
+#endif
+#endif
+
+#ifndef RN2XX3_QUEUE_ENTRIES
+#ifdef __AVR__
+#define RN2XX3_QUEUE_ENTRIES 8
+#else
+#define RN2XX3_QUEUE_ENTRIES 16
+#endif
+#endif
+
+/*
+ * Messages in a frame are each preceded by a byte with their length:
+ *
+ *   <length 1><message 1><length 2><message 2>...
+ *
+ * unpack() splits such a frame again, for use on the receiving side.
+ *
+ * The messages are kept framed in one buffer. Sending moves the messages
+ * chosen for a frame to the front, so the frame is sent from the buffer
+ * itself without a copy.
+ */
+class rn2xx3_queue
+{
+public:
+#if RN2XX3_QUEUE_BYTES > 0
+  rn2xx3_queue();
+
+  /*
+     * Queue a message. Lower priority values go first.
+     * deadline is the millis() value by which it should be sent.
+     * Returns false when the queue has no room for it.
+     */
+  bool push(const uint8_t *data, uint8_t size, uint8_t priority, unsigned long deadline);
+
+  // Number of queued messages, including those of a frame being sent
+  uint8_t count() const { return _count; }
+
+  /*
+     * True when a frame should be sent: a message has priority 0, a
+     * deadline has passed, or the messages fill a frame of capacity bytes.
+     */
+  bool due(unsigned long nowMs, uint16_t capacity) const;
+
+  /*
+     * Choose the messages for a frame of at most capacity bytes, by
+     * priority and then in order of arrival, and move them to the front.
+     * Returns the frame length, 0 when no message fits or a frame is
+     * still being sent.
+     */
+  uint16_t prepareFrame(uint16_t capacity);
+
+  const uint8_t *frame() const { return _buffer; }
+  bool sending() const { return _frameMessages > 0; }
+
+  // The frame was sent or given up, remove its messages
+  uint8_t completeFrame();
+
+  /*
+     * Remove the messages that do not fit a frame of capacity bytes even
+     * on their own. Returns how many were removed.
+     */
+  uint8_t dropLarger(uint16_t capacity);
+#endif
+
+  /*
+     * Split a frame into its messages. Stores up to max pointers and
+     * lengths, returns the number of messages or -1 if the frame is
+     * malformed.
+     */
+  static int unpack(const uint8_t *frame, uint16_t length, const uint8_t **messages, uint8_t *lengths, uint8_t max);
+
+#if RN2XX3_QUEUE_BYTES > 0
+private:
+  // Move the message at index from to index to, which is lower
+  void move(uint8_t from, uint8_t to);
+  void remove(uint8_t index);
+  uint16_t offsetOf(uint8_t index) const;
+
+  uint8_t _buffer[RN2XX3_QUEUE_BYTES];
+  uint16_t _bytes;
+  uint8_t _count;
+  uint8_t _frameMessages;
+  uint16_t _frameBytes;
+  uint8_t _priority[RN2XX3_QUEUE_ENTRIES];
+  unsigned long _deadline[RN2XX3_QUEUE_ENTRIES];
+#endif
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Allocation free parser for the replies of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_reply.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+// All keywords, in the order of rn2xx3_reply::type_t
+static const char KEYWORDS[] PROGMEM =
+    "busy\0"
+    "frame_counter_err_rejoin_needed\0"
+    "invalid_data_len\0"
+    "invalid_param\0"
+    "mac_err\0"
+    "mac_paused\0"
+    "mac_rx\0"
+    "mac_tx_ok\0"
+    "no_free_ch\0"
+    "not_joined\0"
+    "ok\0"
+    "radio_err\0"
+    "radio_tx_ok\0"
+    "radio_rx\0"
+    "silent\0"
+    "accepted\0"
+    "denied\0"
+    "keys_not_init";
+
+// Offset of each keyword in KEYWORDS
+static const uint8_t KEYWORD_OFFSETS[] PROGMEM = {
+    0, 5, 37, 54, 68, 76, 87, 94, 104, 115, 126, 129, 139, 151, 160, 167, 176, 183};
+
+/*
+ * Perfect hash of the keywords: (7 * length + first + 6 * last) % 32.
+ * Every keyword lands in its own slot, 0xFF marks an empty slot.
+ */
+#define HASH(length, first, last) ((uint8_t)((length) * 7 + (first) + (last) * 6) & 31)
+
+static const uint8_t KEYWORD_SLOTS[32] PROGMEM = {
+    0xFF, rn2xx3_reply::radio_tx_ok, 0xFF, 0xFF,
+    rn2xx3_reply::no_free_ch, 0xFF, rn2xx3_reply::denied, rn2xx3_reply::mac_rx,
+    0xFF, 0xFF, rn2xx3_reply::mac_err, rn2xx3_reply::mac_paused,
+    rn2xx3_reply::not_joined, rn2xx3_reply::invalid_data_len, rn2xx3_reply::mac_tx_ok, 0xFF,
+    0xFF, rn2xx3_reply::accepted, rn2xx3_reply::invalid_param, 0xFF,
+    rn2xx3_reply::busy, rn2xx3_reply::silent, 0xFF, rn2xx3_reply::frame_counter_err_rejoin_needed,
+    0xFF, 0xFF, rn2xx3_reply::radio_rx, 0xFF,
+    0xFF, rn2xx3_reply::radio_err, rn2xx3_reply::keys_not_init, rn2xx3_reply::ok};
+
+rn2xx3_reply::type_t rn2xx3_reply::classify(const char *line, uint16_t length)
+{
+  // The keyword is the first word of the line
+  uint16_t wordLength = 0;
+  while (wordLength < length && line[wordLength] != ' ')
+    wordLength++;
+  if (wordLength < 2 || wordLength > 31)
+    return UNKNOWN;
+
+  uint8_t index = pgm_read_byte(&KEYWORD_SLOTS[HASH(wordLength, (uint8_t)line[0], (uint8_t)line[wordLength - 1])]);
+  if (index == 0xFF)
+    return UNKNOWN;
+
+  PGM_P keyword = KEYWORDS + pgm_read_byte(&KEYWORD_OFFSETS[index]);
+  if (strlen_P(keyword) != wordLength || strncmp_P(line, keyword, wordLength) != 0)
+    return UNKNOWN;
+  return (type_t)index;
+}
+
+rn2xx3_reply::type_t rn2xx3_reply::parse(const char *line, uint16_t length)
+{
+  type = classify(line, length);
+  port = 0;
+  payloadOffset = length;
+  payloadLength = 0;
+
+  uint16_t i;
+  switch (type)
+  {
+  case mac_rx:
+    //example: mac_rx 1 54657374696E6720313233
+    i = 7;
+    while (i < length && line[i] >= '0' && line[i] <= '9')
+    {
+      port = port * 10 + (line[i] - '0');
+      i++;
+    }
+    break;
+
+  case radio_rx:
+    //example: radio_rx  54657374696E6720313233
+    i = 9;
+    break;
+
+  default:
+    return type;
+  }
+
+  while (i < length && line[i] == ' ')
+    i++;
+  payloadOffset = i;
+  payloadLength = length - i;
+  return type;
+}
@@ -0,0 +1,63 @@
+/*
+ * Allocation free parser for the replies of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_reply_h
+#define rn2xx3_reply_h
+
+#include "Arduino.h"
+
+/*
+ * The meaning of a reply line, and where its fields are.
+ * Classifying looks up the first word of the line in a perfect hash table,
+ * so it takes the same few steps for every keyword.
+ */
+class rn2xx3_reply
+{
+public:
+  enum type_t
+  {
+    busy,
+    frame_counter_err_rejoin_needed,
+    invalid_data_len,
+    invalid_param,
+    mac_err,
+    mac_paused,
+    mac_rx,
+    mac_tx_ok,
+    no_free_ch,
+    not_joined,
+    ok,
+    radio_err,
+    radio_tx_ok,
+    radio_rx,
+    silent,
+    accepted,
+    denied,
+    keys_not_init,
+    UNKNOWN
+  };
+
+  type_t type;
+
+  // FPort of a mac_rx, 0 otherwise
+  uint8_t port;
+
+  // Position and length of the HEX payload of a mac_rx or radio_rx
+  uint16_t payloadOffset;
+  uint16_t payloadLength;
+
+  /*
+     * Classify a line (without line ending) and locate its fields.
+     * Returns the type, which is also stored in this object.
+     */
+  type_t parse(const char *line, uint16_t length);
+
+  /*
+     * Only classify a line.
+     */
+  static type_t classify(const char *line, uint16_t length);
+};
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * Counters and latency histograms of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#include "Arduino.h"
+#include "rn2xx3_stats.h"
+
+extern "C"
+{
+#include <string.h>
+}
+
+void rn2xx3_stats::reset()
+{
+  memset(this, 0, sizeof(*this));
+}
+
+uint8_t rn2xx3_stats::bucket(unsigned long ms)
+{
+  uint8_t n = 0;
+  while (ms > 0 && n < RN2XX3_LATENCY_BUCKETS - 1)
+  {
+    ms >>= 1;
+    n++;
+  }
+  return n;
+}
+
+void rn2xx3_stats::record(uint16_t *histogram, unsigned long ms)
+{
+  uint16_t &count = histogram[bucket(ms)];
+  if (count < 65535)
+    count++;
+}
@@ -0,0 +1,52 @@
+/*
+ * Counters and latency histograms of a Microchip RN2xx3 LoRa radio.
+ *
+ */
+
+#ifndef rn2xx3_stats_h
+#define rn2xx3_stats_h
+
+#include "Arduino.h"
+
+// 0 leaves the counters out of rn2xx3; getStats() then reports zeros
+#ifndef RN2XX3_STATS
+#define RN2XX3_STATS 1
+#endif
+
+/*
+ * Buckets of the latency histograms. Bucket 0 counts latencies below
+ * 1 ms, bucket n those from 2^(n-1) up to 2^n ms, and the last bucket
+ * everything longer.
+ */
+#ifndef RN2XX3_LATENCY_BUCKETS
+#define RN2XX3_LATENCY_BUCKETS 16
+#endif
+
+struct rn2xx3_stats
+{
+  unsigned long commands;     // command lines written, tx attempts included
+  unsigned long bytesWritten; // to the RN2xx3, line endings included
+  unsigned long bytesRead;    // from the RN2xx3, line endings included
+  unsigned long retries;      // tx attempts after the first
+  unsigned long busy;
+  unsigned long noFreeChannel;
+  unsigned long notJoined;
+  unsigned long macErr;
+  unsigned long rejoins; // re-initialisations an error asked for, see rejoin()
+  unsigned long longDownlinks; // dropped, as their line did not fit RN2XX3_LINE_BUFFER_SIZE
+
+  // From writing a command to its reply, pipelined commands included
+  uint16_t commandLatency[RN2XX3_LATENCY_BUCKETS];
+
+  // From the "ok" to a tx command to the end of the uplink
+  uint16_t txLatency[RN2XX3_LATENCY_BUCKETS];
+
+  void reset();
+
+  // Count a latency in a histogram, which stops at 65535
+  static void record(uint16_t *histogram, unsigned long ms);
+
+  static uint8_t bucket(unsigned long ms);
+};
+
+#endif